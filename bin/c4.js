@@ -0,0 +1,13 @@
+{
+"projectile":[[11.99671, 6],[1.00728, 1],[4.00151, 2]],
+"energy":{
+    "min": 100,
+    "max": 1000,
+    "num": 1000
+    },
+"materials":[
+            [{"A":12.0107, "Z":6, "thickness":1.0},
+             {"A":55.845, "Z":26, "density":7.8, "thickness":0.05}],
+            {"A":12, "Z":6, "density":2.0, "thickness":1.0}
+            ]
+}
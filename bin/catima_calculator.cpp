@@ -4,10 +4,30 @@
 #include <iostream>
 #include <math.h>
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
 #include "catima/catima.h"
+#include "catima/batch.h"
+#include "catima/byte_order.h"
 #include "catima/nucdata.h"
+#if defined(__unix__) || defined(__APPLE__)
+#define CATIMA_UNIX_SOCKETS
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 #include <nlohmann/json.hpp>
 
 using namespace std;
@@ -15,7 +35,15 @@ using namespace catima;
 using json = nlohmann::json;
 
 void help(){
-        std::cout<<"usage: catima_calculator config_file.json\n";
+        std::cout<<"usage: catima_calculator config_file.json [--format csv|jsonl|binary] [--threads N] [--output file]\n";
+        std::cout<<"       catima_calculator --server [--threads N]\n";
+        std::cout<<"       catima_calculator --socket path [--threads N]\n";
+        std::cout<<"  --format  scan mode, results of all projectiles, material stacks and energies are streamed in the format\n";
+        std::cout<<"            binary is columnar, little-endian and 8 bytes aligned\n";
+        std::cout<<"  --threads number of threads of the scan or server, default is number of cores\n";
+        std::cout<<"  --output  output file of the scan, default is standard output\n";
+        std::cout<<"  --server  answers JSON requests, one per line, read from standard input\n";
+        std::cout<<"  --socket  answers JSON requests, one per line, of clients connected to the unix domain socket\n";
 }
 
 inline std::vector<double> linspace_vector(double a, double b, unsigned int num){
@@ -34,158 +62,270 @@ inline std::vector<double> linspace_vector(double a, double b, unsigned int num)
 json load_json(const char *fname);
 char* getCmdOption(char ** begin, char ** end, const std::string & option);
 Material json_material(json &j);
+Layers json_layers(json &j);
 
-int main( int argc, char * argv[] )
-{
-    Projectile projectile;
-    Layers layers;
+struct CalculatorInput{
+    std::vector<Projectile> projectiles;
+    std::vector<Layers> stacks;
     std::vector<double> energies;
     Config conf;
+};
+
+CalculatorInput json_input(json &j, bool verbose=true);
+const char* input_error(const CalculatorInput &input);
+void serve_stream(std::istream &in, std::ostream &out, unsigned int nthreads);
+int serve_socket(const char *path, unsigned int nthreads);
+
+struct ScanOptions{
+    std::string format;
+    std::string output;
+    unsigned int threads = 0;
+    std::size_t chunk = 4096; // number of results calculated before they are written
+};
+
+void scan(const std::vector<Projectile> &projectiles, const std::vector<Layers> &stacks,
+          const std::vector<double> &energies, const Config &conf, const ScanOptions &opt);
+
+int main( int argc, char * argv[] )
+{
+    CalculatorInput input;
+    ScanOptions scan_options;
     
     if(argc == 1 ){
         help();
         return 0;
     }
-    try{
-        auto j = load_json(argv[1]);
-            
-            // load projectile data
-            if(j.count("projectile")){
-                if(j["projectile"].is_array()){
-                    projectile.A = j["projectile"].at(0).get<double>();
-                    projectile.Z = j["projectile"].at(1).get<double>();
-                }
-            }
-            else{
-                throw std::invalid_argument("projectile field is missing");
-            }   
-
-            // load energy data
-            if(j.count("energy")){
-                auto e = j.at("energy");
-                if(e.is_number()){
-                    energies.push_back(j["energy"].get<double>());
-                    }
-                if(e.is_string()){
-                    double _e = std::stod(j["energy"].get<std::string>());
-                    energies.push_back(_e);
-                    }
-                if(e.is_array()){
-                    for(auto &el:e){
-                        if(el.is_number())
-                        energies.push_back(el.get<double>());
-                        }
-                    }
-                if(e.is_object()){
-                    if(e.count("min")>0 && e.count("max")>0 && (e.count("num")>0 || e.count("step")>0)){
-                        double emin = e["min"].get<double>();
-                        double emax = e["max"].get<double>();
-                        int num=0;
-                        if(e.count("step")){
-                            num = 1+(emax-emin)/e["step"].get<int>();
-                        }
-                        if(e.count("num")){
-                            num = e["num"].get<int>();
-                        }
-                        if(num>2)
-                            energies  =  linspace_vector(emin,emax,num);
-                    }
-                }
-                }
-                else{
-                    throw std::invalid_argument("energy field is missing");
-                    }
-         
-            if(j.count("material")){
-                auto e = j.at("material");
-                if(e.is_array()){
-                    for(auto& entry : e){
-                        if(!entry.is_object()){
-                            throw std::invalid_argument("material error");
-                            }
-                        layers.add(json_material(entry));
-                        }
-                    }
-                if(e.is_object()){
-                    layers.add(json_material(e));
-                    }
-                }
-            else{
-                throw std::invalid_argument("material field is missing");
-                }
-            if(j.count("config")>0){
-                auto e = j["config"];
-                if(e.is_string()){
-                    std::string cstr = e.get<std::string>();
-                    if(cstr=="atimav1.3"){
-                        conf.z_effective = z_eff_type::pierce_blann;
-                        cout<<"using config: Atima v1.3\n";
-                    }
-                    if(cstr=="atimav1.4"){
-                        conf.z_effective = z_eff_type::atima14;
-                        cout<<"using config: Atima v1.4\n";
-                    }
-                }
-            }
-                
-        } // end of try 
+    if(char *o = getCmdOption(argv, argv+argc, "--format")){
+        scan_options.format = o;
+        if(scan_options.format!="csv" && scan_options.format!="jsonl" && scan_options.format!="binary"){
+            help();
+            return 0;
+        }
+    }
+    if(char *o = getCmdOption(argv, argv+argc, "--threads")){
+        try{
+            std::size_t pos = 0;
+            long n = std::stol(o, &pos);
+            if(o[pos]!='\0' || n<1)throw std::invalid_argument("threads");
+            scan_options.threads = static_cast<unsigned int>(n);
+        }
         catch(...){
-            cout<<"Could not load the config file"<<"\n";
+            cout<<"--threads requires positive number\n";
+            help();
             return 0;
         }
+    }
+    if(char *o = getCmdOption(argv, argv+argc, "--output")){
+        scan_options.output = o;
+    }
+    if(std::find(argv, argv+argc, std::string("--server")) != argv+argc){
+        serve_stream(cin, cout, scan_options.threads);
+        return 1;
+    }
+    if(char *o = getCmdOption(argv, argv+argc, "--socket")){
+        return serve_socket(o, scan_options.threads);
+    }
+    try{
+        auto j = load_json(argv[1]);
+        input = json_input(j);
+    }
+    catch(...){
+        cout<<"Could not load the config file"<<"\n";
+        return 0;
+    }
+    if(const char *error = input_error(input)){
+        cout<<error<<"\n";
+        return 0;
+    }
 
+    std::vector<Projectile> &projectiles = input.projectiles;
+    std::vector<Layers> &stacks = input.stacks;
+    std::vector<double> &energies = input.energies;
+    Config &conf = input.conf;
 
-    if(layers.num()==0){
-        cout<<"no material specified\n";
-        return 0;
+    if(!scan_options.format.empty()){
+        try{
+            scan(projectiles, stacks, energies, conf, scan_options);
         }
-
-    if(energies.size()==0){
-        cout<<"no energy specified\n";
-        return 0;
+        catch(std::exception &e){
+            cerr<<e.what()<<"\n";
+            return 0;
+        }
+        return 1;
     }
     
     cout<<"******** CAtima calculator ********\n";
-    cout<<"Projectile: A = "<<projectile.A<<", Z = "<<projectile.Z<<"\n";
-    cout<<"Materials:\n";
-    for(unsigned int i=0;i<layers.num();i++){
-        cout<<"#"<<i;
-        cout<<": density = "<<layers[i].density()<<" g/cm3";
-        cout<<", thickness = "<<layers[i].thickness()<<" g/cm2";
-        cout<<"\n";
+    for(Projectile &projectile:projectiles){
+        for(Layers &layers:stacks){
+            cout<<"Projectile: A = "<<projectile.A<<", Z = "<<projectile.Z<<"\n";
+            cout<<"Materials:\n";
+            for(unsigned int i=0;i<layers.num();i++){
+                cout<<"#"<<i;
+                cout<<": density = "<<layers[i].density()<<" g/cm3";
+                cout<<", thickness = "<<layers[i].thickness()<<" g/cm2";
+                cout<<"\n";
+            }
+
+            for(double e:energies){
+                cout<<"-------- T = "<<e<<" MeV/u -------\n";
+                projectile.T = e;
+                auto res = calculate(projectile,layers);
+                for(unsigned int i=0;i<res.results.size();i++){
+                    auto entry = res.results[i];
+                    cout<<"material #"<<i<<":\n";
+                    cout<<"\tEin = "<<entry.Ein<< " MeV/u\n";
+                    cout<<"\tEout = "<<entry.Eout<<" MeV/u\n";
+                    cout<<"\tsigma_E = "<<entry.sigma_E<<" MeV\n";
+                    cout<<"\tEloss = "<<entry.Eloss<<" MeV\n";
+                    cout<<"\trange = "<<entry.range<<" g/cm2\n";
+                    cout<<"\tsigma_r = "<<entry.sigma_r<<" g/cm2\n";
+                    cout<<"\tsigma_a = "<<entry.sigma_a<<" rad\n";
+                    cout<<"\tdEdx(Ein) = "<<entry.dEdxi<<" MeV/g/cm2\n";
+                    cout<<"\tTOF = "<<entry.tof<<" ns\n";
+                }
+                cout<<"total:\n";
+                cout<<"\tEout = "<<res.total_result.Eout<<" MeV/u\n";
+                cout<<"\tBeta = "<<beta_from_T(res.total_result.Eout)<<"\n";
+                cout<<"\tGamma = "<<gamma_from_T(res.total_result.Eout)<<"\n";
+                cout<<"\tP = "<<p_from_T(res.total_result.Eout, projectile.A)<<" MeV/c\n";
+                cout<<"\tEloss = "<<res.total_result.Eloss<<" MeV\n";
+                cout<<"\tsigma_E = "<<res.total_result.sigma_E<<" MeV\n";
+                cout<<"\tsigma_a = "<<res.total_result.sigma_a<<" rad\n";
+                cout<<"\tTOF = "<<res.total_result.tof<<" ns\n";
+            }
         }
-    
-    for(double e:energies){ 
-        cout<<"-------- T = "<<e<<" MeV/u -------\n";
-        projectile.T = e;
-        auto res = calculate(projectile,layers);
-        for(unsigned int i=0;i<res.results.size();i++){
-            auto entry = res.results[i];
-            cout<<"material #"<<i<<":\n";
-            cout<<"\tEin = "<<entry.Ein<< " MeV/u\n";
-            cout<<"\tEout = "<<entry.Eout<<" MeV/u\n";
-            cout<<"\tsigma_E = "<<entry.sigma_E<<" MeV\n";
-            cout<<"\tEloss = "<<entry.Eloss<<" MeV\n";
-            cout<<"\trange = "<<entry.range<<" g/cm2\n";
-            cout<<"\tsigma_r = "<<entry.sigma_r<<" g/cm2\n";
-            cout<<"\tsigma_a = "<<entry.sigma_a<<" rad\n";
-            cout<<"\tdEdx(Ein) = "<<entry.dEdxi<<" MeV/g/cm2\n";
-            cout<<"\tTOF = "<<entry.tof<<" ns\n";
-            }
-        cout<<"total:\n";
-        cout<<"\tEout = "<<res.total_result.Eout<<" MeV/u\n";
-        cout<<"\tBeta = "<<beta_from_T(res.total_result.Eout)<<"\n";
-        cout<<"\tGamma = "<<gamma_from_T(res.total_result.Eout)<<"\n";
-        cout<<"\tP = "<<p_from_T(res.total_result.Eout, projectile.A)<<" MeV/c\n";
-        cout<<"\tEloss = "<<res.total_result.Eloss<<" MeV\n";
-        cout<<"\tsigma_E = "<<res.total_result.sigma_E<<" MeV\n";
-        cout<<"\tsigma_a = "<<res.total_result.sigma_a<<" rad\n";
-        cout<<"\tTOF = "<<res.total_result.tof<<" ns\n";
     }
 
     return 1;
 }
 
+// columns of the scan output, the keys are followed by the fields filled in the total Result of the Layers
+const char *scan_keys[] = {"A", "Z", "stack", "T"};
+const std::pair<const char*, double Result::*> scan_fields[] = {
+    {"Ein", &Result::Ein}, {"Eout", &Result::Eout}, {"Eloss", &Result::Eloss},
+    {"sigma_E", &Result::sigma_E}, {"sigma_a", &Result::sigma_a},
+    {"sigma_x", &Result::sigma_x}, {"cov", &Result::cov}, {"tof", &Result::tof}
+};
+constexpr std::size_t nscan_keys = sizeof(scan_keys)/sizeof(scan_keys[0]);
+constexpr std::size_t nscan_fields = sizeof(scan_fields)/sizeof(scan_fields[0]);
+
+/**
+ * writes the scan results in chunks
+ * csv and jsonl write one row per result,
+ * binary writes header: "CATIMASC", uint32 number of columns, null terminated column names and zero padding
+ * to multiple of 8 bytes, then for every chunk: uint64 number of rows followed by the columns as arrays of doubles,
+ * all numbers are little-endian, so the arrays are 8 bytes aligned and can be viewed without copying
+ */
+class ScanWriter{
+    public:
+    ScanWriter(std::ostream &out, const std::string &format):out(out),format(format){
+        out.precision(std::numeric_limits<double>::max_digits10);
+        if(format=="csv"){
+            for(std::size_t k=0;k<nscan_keys;k++)out<<(k?",":"")<<scan_keys[k];
+            for(std::size_t k=0;k<nscan_fields;k++)out<<","<<scan_fields[k].first;
+            out<<"\n";
+        }
+        if(format=="binary"){
+            out.write("CATIMASC", 8);
+            write_binary(static_cast<std::uint32_t>(nscan_keys + nscan_fields));
+            std::size_t size = 8 + sizeof(std::uint32_t);
+            for(const char *k:scan_keys){
+                out.write(k, std::strlen(k)+1);
+                size += std::strlen(k)+1;
+            }
+            for(const auto &f:scan_fields){
+                out.write(f.first, std::strlen(f.first)+1);
+                size += std::strlen(f.first)+1;
+            }
+            const char padding[8] = {};
+            out.write(padding, (8-size%8)%8);
+        }
+    }
+
+    // writes results res[i] of projectile p, layers stack and energies T[i]
+    void write(const Projectile &p, std::size_t stack, const double *T, const Result *res, std::size_t n){
+        if(format=="binary"){
+            write_binary(static_cast<std::uint64_t>(n));
+            const double keys[3] = {p.A, p.Z, static_cast<double>(stack)};
+            for(double key:keys){
+                for(std::size_t i=0;i<n;i++)write_binary(key);
+            }
+            for(std::size_t i=0;i<n;i++)write_binary(T[i]);
+            for(const auto &f:scan_fields){
+                for(std::size_t i=0;i<n;i++)write_binary(res[i].*f.second);
+            }
+            return;
+        }
+        for(std::size_t i=0;i<n;i++){
+            const double keys[nscan_keys] = {p.A, p.Z, static_cast<double>(stack), T[i]};
+            if(format=="csv"){
+                for(std::size_t k=0;k<nscan_keys;k++)out<<(k?",":"")<<keys[k];
+                for(const auto &f:scan_fields)out<<","<<res[i].*f.second;
+            }
+            else{
+                out<<"{";
+                for(std::size_t k=0;k<nscan_keys;k++)out<<(k?",\"":"\"")<<scan_keys[k]<<"\":"<<keys[k];
+                for(const auto &f:scan_fields)out<<",\""<<f.first<<"\":"<<res[i].*f.second;
+                out<<"}";
+            }
+            out<<"\n";
+        }
+    }
+
+    void flush(){out.flush();}
+
+    private:
+    template<typename T>
+    void write_binary(T v){
+        v = convert_little_endian(v);
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    std::ostream &out;
+    std::string format;
+};
+
+/**
+ * calculates all projectiles, layer stacks and energies, the energies are split to chunks
+ * which are calculated in parallel and written in order stack, projectile, energy
+ */
+void scan(const std::vector<Projectile> &projectiles, const std::vector<Layers> &stacks,
+          const std::vector<double> &energies, const Config &conf, const ScanOptions &opt){
+    std::unique_ptr<ThreadPool> own_pool;
+    if(opt.threads>0)own_pool = std::make_unique<ThreadPool>(opt.threads);
+    ThreadPool &pool = own_pool?*own_pool:default_thread_pool();
+
+    std::ofstream file;
+    if(!opt.output.empty()){
+        file.open(opt.output, opt.format=="binary"?std::ios::out|std::ios::binary:std::ios::out);
+        if(!file)throw std::invalid_argument("Could not open output file");
+    }
+    ScanWriter writer(opt.output.empty()?cout:file, opt.format);
+
+    // chunk holds about opt.chunk results, either several projectiles with all energies
+    // or single projectile with part of the energies
+    const std::size_t ne = energies.size();
+    const std::size_t energies_per_chunk = std::min(ne, opt.chunk);
+    const std::size_t projectiles_per_chunk = std::max<std::size_t>(1, opt.chunk/ne);
+    std::vector<Result> res;
+    for(std::size_t is=0;is<stacks.size();is++){
+        for(std::size_t ip=0;ip<projectiles.size();ip+=projectiles_per_chunk){
+            const std::size_t np = std::min(projectiles_per_chunk, projectiles.size()-ip);
+            std::vector<Projectile> chunk_projectiles(projectiles.begin()+ip, projectiles.begin()+ip+np);
+            for(std::size_t ie=0;ie<ne;ie+=energies_per_chunk){
+                const std::size_t nk = std::min(energies_per_chunk, ne-ie);
+                std::vector<double> chunk_energies(energies.begin()+ie, energies.begin()+ie+nk);
+                res.resize(np*nk);
+                calculate_batch(chunk_projectiles, chunk_energies, stacks[is], res.data(), conf, pool);
+                for(std::size_t i=0;i<np;i++){
+                    writer.write(chunk_projectiles[i], is, chunk_energies.data(), res.data()+i*nk, nk);
+                }
+                writer.flush();
+            }
+        }
+    }
+}
+
 
 
 json load_json(const char *fname){
@@ -213,6 +353,371 @@ json load_json(const char *fname){
     }
 };
 
+/**
+ * answers single request, the request has the same fields as the config file and optional "id",
+ * the response is single line JSON object with the "id" and the columns A, Z, stack, T
+ * and the total Result fields in order stack, projectile, energy, or with the "error" field
+ */
+std::string handle_request(const std::string &line, ThreadPool &pool){
+    json response;
+    try{
+        json j = json::parse(line);
+        if(j.count("id"))response["id"] = j["id"];
+        CalculatorInput input = json_input(j, false);
+        if(const char *error = input_error(input))throw std::invalid_argument(error);
+
+        std::vector<std::vector<double>> columns(nscan_keys+nscan_fields);
+        std::vector<Result> res(input.projectiles.size()*input.energies.size());
+        for(std::size_t is=0;is<input.stacks.size();is++){
+            calculate_batch(input.projectiles, input.energies, input.stacks[is], res.data(), input.conf, pool);
+            for(std::size_t i=0;i<res.size();i++){
+                const Projectile &p = input.projectiles[i/input.energies.size()];
+                const double keys[nscan_keys] = {p.A, p.Z, static_cast<double>(is), input.energies[i%input.energies.size()]};
+                for(std::size_t k=0;k<nscan_keys;k++)columns[k].push_back(keys[k]);
+                for(std::size_t k=0;k<nscan_fields;k++)columns[nscan_keys+k].push_back(res[i].*scan_fields[k].second);
+            }
+        }
+        for(std::size_t k=0;k<nscan_keys;k++)response[scan_keys[k]] = columns[k];
+        for(std::size_t k=0;k<nscan_fields;k++)response[scan_fields[k].first] = columns[nscan_keys+k];
+    }
+    catch(std::exception &e){
+        response["error"] = e.what();
+    }
+    catch(...){
+        response["error"] = "invalid request";
+    }
+    return response.dump();
+}
+
+/**
+ * answers requests read line by line from the stream in, the DataPoints stay cached between the requests
+ * each request is calculated in parallel
+ */
+void serve_stream(std::istream &in, std::ostream &out, unsigned int nthreads){
+    std::unique_ptr<ThreadPool> own_pool;
+    if(nthreads>0)own_pool = std::make_unique<ThreadPool>(nthreads);
+    ThreadPool &pool = own_pool?*own_pool:default_thread_pool();
+    std::string line;
+    while(std::getline(in, line)){
+        if(line.find_first_not_of(" \t\r") == std::string::npos)continue;
+        out<<handle_request(line, pool)<<"\n";
+        out.flush();
+    }
+}
+
+#ifdef CATIMA_UNIX_SOCKETS
+namespace{
+    bool write_all(int fd, const std::string &data){
+        std::size_t done = 0;
+        while(done<data.size()){
+            ssize_t n = write(fd, data.data()+done, data.size()-done);
+            if(n<0 && errno==EINTR)continue;
+            if(n<=0)return false;
+            done += n;
+        }
+        return true;
+    }
+
+    constexpr std::size_t max_request_size = 4*1024*1024; // longest accepted request line in bytes
+
+    // connected client, guarded by the mutex of serve_socket
+    struct Client{
+        int fd;
+        std::string buffer; // incomplete line, used only by the polling thread
+        std::deque<std::string> pending; // request lines not yet answered, empty line marks too long request
+        bool busy = false; // a request of the client is being calculated or the client is queued
+        bool eof = false; // client closed the connection or the write failed
+        bool polled = true; // fd is in the poll set of the polling thread
+    };
+
+    // the connection is closed when the client is gone, not polled and all its requests are answered
+    void close_if_done(Client &c){
+        if(c.eof && !c.busy && !c.polled && c.fd>=0){
+            close(c.fd);
+            c.fd = -1;
+        }
+    }
+}
+
+/**
+ * listens on the unix domain socket, the requests of all clients are read by a single polling thread
+ * and calculated by nthreads threads, one request at the time, so any number of idle clients can stay connected
+ * the requests of the same client are answered in order, the DataPoints are shared in _shared_storage
+ */
+int serve_socket(const char *path, unsigned int nthreads){
+    sockaddr_un addr{};
+    if(std::strlen(path)>=sizeof(addr.sun_path)){
+        cerr<<"socket path is too long\n";
+        return 0;
+    }
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server<0){
+        cerr<<"could not create socket\n";
+        return 0;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
+    unlink(path);
+    if(bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))<0 || listen(server, 64)<0){
+        cerr<<"could not listen on "<<path<<"\n";
+        close(server);
+        return 0;
+    }
+    std::signal(SIGPIPE, SIG_IGN); // disconnected client must not terminate the server
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<Client>> queue; // clients with pending requests
+    bool stop = false;
+    if(nthreads==0)nthreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for(unsigned int i=0;i<nthreads;i++){
+        workers.emplace_back([&]{
+            ThreadPool serial(1);
+            for(;;){
+                std::shared_ptr<Client> c;
+                std::string line;
+                int fd;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&]{return stop || !queue.empty();});
+                    if(queue.empty())return;
+                    c = queue.front();
+                    queue.pop_front();
+                    line = std::move(c->pending.front());
+                    c->pending.pop_front();
+                    fd = c->fd;
+                }
+                // only the thread holding the busy client writes to it, the fd is not closed meanwhile
+                const std::string response = line.empty()?json({{"error", "request is too long"}}).dump()
+                                                          :handle_request(line, serial);
+                bool written = write_all(fd, response+"\n");
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(!written){
+                        c->eof = true;
+                        c->pending.clear();
+                    }
+                    if(!c->pending.empty()){
+                        queue.push_back(c); // other clients are served first
+                        ready.notify_one();
+                    }
+                    else{
+                        c->busy = false;
+                    }
+                    close_if_done(*c);
+                }
+            }
+            });
+    }
+
+    std::vector<std::shared_ptr<Client>> clients;
+    std::vector<pollfd> fds;
+    char chunk[4096];
+    for(;;){
+        fds.clear();
+        fds.push_back({server, POLLIN, 0});
+        for(auto &c:clients)fds.push_back({c->fd, POLLIN, 0});
+        if(poll(fds.data(), fds.size(), -1)<0){
+            if(errno==EINTR)continue;
+            cerr<<"poll failed\n";
+            break;
+        }
+
+        for(std::size_t i=1;i<fds.size();i++){
+            if(fds[i].revents==0)continue;
+            Client &c = *clients[i-1];
+            ssize_t n = read(fds[i].fd, chunk, sizeof(chunk));
+            if(n<0 && errno==EINTR)continue;
+            std::lock_guard<std::mutex> lock(mutex);
+            if(n<=0){
+                c.eof = true;
+                continue;
+            }
+            if(c.eof)continue; // write failed, the rest is ignored
+            c.buffer.append(chunk, n);
+            std::size_t begin = 0;
+            std::size_t end;
+            while((end = c.buffer.find('\n', begin)) != std::string::npos){
+                std::string line = c.buffer.substr(begin, end-begin);
+                begin = end+1;
+                if(line.find_first_not_of(" \t\r") == std::string::npos)continue;
+                c.pending.push_back(std::move(line));
+            }
+            c.buffer.erase(0, begin);
+            if(c.buffer.size()>max_request_size){
+                // the error is answered after the previous requests and the connection is dropped
+                c.buffer.clear();
+                c.buffer.shrink_to_fit();
+                c.pending.emplace_back();
+                c.eof = true;
+            }
+            if(!c.busy && !c.pending.empty()){
+                c.busy = true;
+                queue.push_back(clients[i-1]);
+                ready.notify_one();
+            }
+        }
+        {
+            // disconnected clients are not polled anymore, workers keep them until their requests are answered
+            std::lock_guard<std::mutex> lock(mutex);
+            clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                         [](const std::shared_ptr<Client> &c){
+                                             if(!c->eof)return false;
+                                             c->polled = false;
+                                             close_if_done(*c);
+                                             return true;
+                                         }),
+                          clients.end());
+        }
+
+        if(fds[0].revents!=0){
+            int fd = accept(server, nullptr, nullptr);
+            if(fd<0){
+                if(errno==EINTR || errno==ECONNABORTED || errno==EAGAIN)continue;
+                cerr<<"accept failed\n";
+                break;
+            }
+            auto c = std::make_shared<Client>();
+            c->fd = fd;
+            clients.push_back(std::move(c));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    ready.notify_all();
+    for(auto &w:workers)w.join();
+    for(auto &c:clients){
+        if(c->fd>=0)close(c->fd);
+    }
+    close(server);
+    unlink(path);
+    return 1;
+}
+#else
+int serve_socket(const char *path, unsigned int nthreads){
+    cerr<<"unix domain sockets are not supported on this platform\n";
+    return 0;
+}
+#endif
+
+CalculatorInput json_input(json &j, bool verbose){
+    CalculatorInput input;
+    std::vector<Projectile> &projectiles = input.projectiles;
+    std::vector<Layers> &stacks = input.stacks;
+    std::vector<double> &energies = input.energies;
+    Config &conf = input.conf;
+
+    // load projectile data, single [A, Z] or list of them
+    if(j.count("projectile")){
+        auto e = j["projectile"];
+        if(e.is_array() && e.size()>0 && e.at(0).is_array()){
+            for(auto &el:e){
+                projectiles.emplace_back(el.at(0).get<double>(), el.at(1).get<double>());
+            }
+        }
+        else if(e.is_array()){
+            projectiles.emplace_back(e.at(0).get<double>(), e.at(1).get<double>());
+        }
+    }
+    else{
+        throw std::invalid_argument("projectile field is missing");
+    }   
+
+    // load energy data
+    if(j.count("energy")){
+        auto e = j.at("energy");
+        if(e.is_number()){
+            energies.push_back(j["energy"].get<double>());
+            }
+        if(e.is_string()){
+            double _e = std::stod(j["energy"].get<std::string>());
+            energies.push_back(_e);
+            }
+        if(e.is_array()){
+            for(auto &el:e){
+                if(el.is_number())
+                energies.push_back(el.get<double>());
+                }
+            }
+        if(e.is_object()){
+            if(e.count("min")>0 && e.count("max")>0 && (e.count("num")>0 || e.count("step")>0)){
+                double emin = e["min"].get<double>();
+                double emax = e["max"].get<double>();
+                int num=0;
+                if(e.count("step")){
+                    num = 1+(emax-emin)/e["step"].get<int>();
+                }
+                if(e.count("num")){
+                    num = e["num"].get<int>();
+                }
+                if(num>2)
+                    energies  =  linspace_vector(emin,emax,num);
+            }
+        }
+        }
+        else{
+            throw std::invalid_argument("energy field is missing");
+            }
+ 
+    // material is single layer stack, materials is list of stacks
+    if(j.count("material")){
+        stacks.push_back(json_layers(j.at("material")));
+        }
+    else if(j.count("materials") && j.at("materials").is_array()){
+        for(auto& entry : j.at("materials")){
+            stacks.push_back(json_layers(entry));
+            }
+        }
+    else{
+        throw std::invalid_argument("material field is missing");
+        }
+    if(j.count("config")>0){
+        auto e = j["config"];
+        if(e.is_string()){
+            std::string cstr = e.get<std::string>();
+            if(cstr=="atimav1.3"){
+                conf.z_effective = z_eff_type::pierce_blann;
+                if(verbose)cerr<<"using config: Atima v1.3\n";
+            }
+            if(cstr=="atimav1.4"){
+                conf.z_effective = z_eff_type::atima14;
+                if(verbose)cerr<<"using config: Atima v1.4\n";
+            }
+        }
+    }
+    return input;
+}
+
+// returns error message if the input can not be calculated, otherwise nullptr
+const char* input_error(const CalculatorInput &input){
+    if(input.projectiles.empty())return "no projectile specified";
+    if(input.stacks.empty() || std::any_of(input.stacks.begin(), input.stacks.end(), [](const Layers &l){return l.num()==0;})){
+        return "no material specified";
+    }
+    if(input.energies.empty())return "no energy specified";
+    return nullptr;
+}
+
+Layers json_layers(json &j){
+    Layers layers;
+    if(j.is_array()){
+        for(auto& entry : j){
+            if(!entry.is_object()){
+                throw std::invalid_argument("material error");
+                }
+            layers.add(json_material(entry));
+            }
+        }
+    if(j.is_object()){
+        layers.add(json_material(j));
+        }
+    return layers;
+    }
+
 Material json_material(json &j){
     if(!j.is_object()){
         throw std::invalid_argument("Wrong material definition");
@@ -239,16 +744,16 @@ Material json_material(json &j){
             z = j["Z"].get<int>();
             }
         if(z<=0){
-            cout<<"Z="<<z<<"\n";
+            cerr<<"Z="<<z<<"\n";
             throw std::invalid_argument("Could not parse json file (material section)");
             }
         
         if(density<=0){
             density = element_density(z);
-            if(density<=0)cout<<"Warning: material density = "<<density<<"\n";
+            if(density<=0)cerr<<"Warning: material density = "<<density<<"\n";
             }
         if(th<=0){
-            cout<<"Warning: material thickness = "<<th<<"\n";
+            cerr<<"Warning: material thickness = "<<th<<"\n";
             }
         
         if(z<200){
@@ -264,7 +769,7 @@ Material json_material(json &j){
         
         }
     catch(...){
-        cout<<"JSON parsing error: material definition\n";
+        cerr<<"JSON parsing error: material definition\n";
         throw std::invalid_argument("Could not parse json file");
         }
     }
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+#include "catima/batch.h"
+#include "catima/catima.h"
+
+namespace catima{
+
+namespace{
+    inline void hash_combine(std::size_t &seed, std::size_t v){
+        seed ^= v + 0x9e3779b97f4a7c15ull + (seed<<6) + (seed>>2);
+    }
+
+    // hash of the DataPoint key, density is compared with tolerance so it is not hashed
+    std::size_t key_hash(const Projectile &p, const Material &m, const Config &c){
+        std::hash<double> hd;
+        std::size_t seed = hd(p.A);
+        hash_combine(seed, hd(p.Z));
+        hash_combine(seed, hd(p.Q));
+        hash_combine(seed, hd(m.I()));
+        hash_combine(seed, hd(m.M()));
+        for(int i=0;i<m.ncomponents();i++){
+            Target e = m.get_element(i);
+            hash_combine(seed, hd(e.A));
+            hash_combine(seed, std::hash<int>()(e.Z));
+            hash_combine(seed, hd(e.stn));
+        }
+        unsigned char cb[sizeof(Config)];
+        std::memcpy(cb, &c, sizeof(Config));
+        for(unsigned char b:cb)hash_combine(seed, b);
+        return seed;
+    }
+
+    /**
+      * DataPoint buffer of the calling thread, every nesting level has its own buffer
+      * the capacity is kept between calls so the warm call does not allocate,
+      * the DataPoints are released at the end of the scope also if the calculation throws
+      */
+    class ScopedDataBuffer{
+    public:
+        ScopedDataBuffer(){
+            if(depth==buffers.size())buffers.emplace_back();
+            buf = &buffers[depth++];
+        }
+        ~ScopedDataBuffer(){
+            buf->clear();
+            depth--;
+        }
+        ScopedDataBuffer(const ScopedDataBuffer&) = delete;
+        ScopedDataBuffer& operator=(const ScopedDataBuffer&) = delete;
+        std::vector<std::shared_ptr<const DataPoint>>& get(){return *buf;}
+    private:
+        // deque keeps the references of outer levels valid when it grows
+        static thread_local std::deque<std::vector<std::shared_ptr<const DataPoint>>> buffers;
+        static thread_local std::size_t depth;
+        std::vector<std::shared_ptr<const DataPoint>> *buf;
+    };
+    thread_local std::deque<std::vector<std::shared_ptr<const DataPoint>>> ScopedDataBuffer::buffers;
+    thread_local std::size_t ScopedDataBuffer::depth = 0;
+
+    template<typename F>
+    auto with_pool(unsigned int nthreads, F&& f){
+        if(nthreads==0)return f(default_thread_pool());
+        ThreadPool pool(nthreads);
+        return f(pool);
+    }
+}
+
+std::vector<std::shared_ptr<const DataPoint>> get_data_batch(const std::vector<Projectile> &projectiles,
+                                                              const std::vector<Material> &materials,
+                                                              const Config &c,
+                                                              ThreadPool &pool){
+    const std::size_t nm = materials.size();
+    std::vector<std::shared_ptr<const DataPoint>> data(projectiles.size()*nm);
+    pool.parallel_for(data.size(), [&](std::size_t i){
+        data[i] = _shared_storage.Get(projectiles[i/nm], materials[i%nm], c);
+        }, 1);
+    return data;
+}
+
+std::vector<Result> calculate_batch(const std::vector<BatchJob> &jobs, ThreadPool &pool){
+    std::vector<Result> res(jobs.size());
+    if(jobs.empty())return res;
+
+    // find unique projectile-material-config combinations
+    std::vector<std::size_t> key(jobs.size());
+    std::vector<std::size_t> unique_jobs; // index of the first job with given key
+    std::unordered_map<std::size_t, std::vector<std::size_t>> buckets;
+    for(std::size_t i=0;i<jobs.size();i++){
+        const BatchJob &j = jobs[i];
+        if(i>0){
+            const BatchJob &prev = jobs[unique_jobs[key[i-1]]];
+            if(prev.p==j.p && prev.m==j.m && prev.c==j.c){
+                key[i] = key[i-1];
+                continue;
+            }
+        }
+        auto &bucket = buckets[key_hash(j.p, j.m, j.c)];
+        std::size_t k = unique_jobs.size();
+        for(std::size_t candidate:bucket){
+            const BatchJob &u = jobs[unique_jobs[candidate]];
+            if(u.p==j.p && u.m==j.m && u.c==j.c){
+                k = candidate;
+                break;
+            }
+        }
+        if(k==unique_jobs.size()){
+            unique_jobs.push_back(i);
+            bucket.push_back(k);
+        }
+        key[i] = k;
+    }
+
+    // DataPoints are calculated in parallel, one per task
+    std::vector<std::shared_ptr<const DataPoint>> data(unique_jobs.size());
+    pool.parallel_for(unique_jobs.size(), [&](std::size_t k){
+        const BatchJob &j = jobs[unique_jobs[k]];
+        data[k] = _shared_storage.Get(j.p, j.m, j.c);
+        }, 1);
+
+    // jobs with the same DataPoint are processed together
+    std::vector<std::size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&key](std::size_t a, std::size_t b){return key[a]<key[b];});
+    pool.parallel_for(order.size(), [&](std::size_t n){
+        const std::size_t i = order[n];
+        res[i] = calculate(*data[key[i]], jobs[i].p.T, jobs[i].m);
+        });
+    return res;
+}
+
+std::vector<Result> calculate_batch(const std::vector<BatchJob> &jobs, unsigned int nthreads){
+    return with_pool(nthreads, [&](ThreadPool &pool){return calculate_batch(jobs, pool);});
+}
+
+void calculate_batch(const std::vector<Projectile> &projectiles,
+                     const std::vector<Material> &materials,
+                     const std::vector<double> &energies,
+                     Result *res,
+                     const Config &c,
+                     ThreadPool &pool){
+    const std::size_t nm = materials.size();
+    const std::size_t ne = energies.size();
+    const std::size_t n = projectiles.size()*nm*ne;
+    if(n==0)return;
+
+    ScopedDataBuffer buffer;
+    auto &data = buffer.get(); // the workers must see the buffer of the calling thread
+    data.resize(projectiles.size()*nm);
+    pool.parallel_for(data.size(), [&](std::size_t i){
+        data[i] = _shared_storage.Get(projectiles[i/nm], materials[i%nm], c);
+        }, 1);
+
+    // results are written in the dense order, so every DataPoint is used by consecutive indices
+    pool.parallel_for(n, [&](std::size_t i){
+        const std::size_t ipm = i/ne;
+        res[i] = calculate(*data[ipm], energies[i%ne], materials[ipm%nm]);
+        });
+}
+
+std::vector<Result> calculate_batch(const std::vector<Projectile> &projectiles,
+                                    const std::vector<Material> &materials,
+                                    const std::vector<double> &energies,
+                                    const Config &c,
+                                    ThreadPool &pool){
+    std::vector<Result> res(projectiles.size()*materials.size()*energies.size());
+    calculate_batch(projectiles, materials, energies, res.data(), c, pool);
+    return res;
+}
+
+std::vector<Result> calculate_batch(const std::vector<Projectile> &projectiles,
+                                    const std::vector<Material> &materials,
+                                    const std::vector<double> &energies,
+                                    const Config &c,
+                                    unsigned int nthreads){
+    return with_pool(nthreads, [&](ThreadPool &pool){return calculate_batch(projectiles, materials, energies, c, pool);});
+}
+
+void calculate_batch(const std::vector<Projectile> &projectiles,
+                     const std::vector<double> &energies,
+                     const Layers &layers,
+                     Result *res,
+                     const Config &c,
+                     ThreadPool &pool){
+    const std::size_t ne = energies.size();
+    const std::size_t n = projectiles.size()*ne;
+    if(n==0)return;
+
+    // DataPoints of all layers for every projectile
+    const std::vector<Material> &materials = layers.get_materials();
+    const std::size_t nl = materials.size();
+    std::vector<std::vector<std::shared_ptr<const DataPoint>>> data(projectiles.size(), std::vector<std::shared_ptr<const DataPoint>>(nl));
+    pool.parallel_for(projectiles.size()*nl, [&](std::size_t i){
+        data[i/nl][i%nl] = _shared_storage.Get(projectiles[i/nl], materials[i%nl], c);
+        }, 1);
+
+    pool.parallel_for(n, [&](std::size_t i){
+        thread_local MultiResult mres; // layer results storage is reused by the worker
+        calculate(data[i/ne], energies[i%ne], Phasespace(), layers, mres);
+        res[i] = mres.total_result;
+        });
+}
+
+std::vector<Result> calculate_batch(const std::vector<Projectile> &projectiles,
+                                    const std::vector<double> &energies,
+                                    const Layers &layers,
+                                    const Config &c,
+                                    unsigned int nthreads){
+    std::vector<Result> res(projectiles.size()*energies.size());
+    with_pool(nthreads, [&](ThreadPool &pool){calculate_batch(projectiles, energies, layers, res.data(), c, pool);});
+    return res;
+}
+
+}
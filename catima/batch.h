@@ -0,0 +1,136 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_BATCH_H
+#define CATIMA_BATCH_H
+
+#include <vector>
+#include <memory>
+#include "catima/structures.h"
+#include "catima/config.h"
+#include "catima/storage.h"
+#include "catima/thread_pool.h"
+
+namespace catima{
+
+    /**
+      * single job of the batch calculation
+      * the energy is taken from p.T and the thickness from m
+      */
+    struct BatchJob{
+        Projectile p;
+        Material m;
+        Config c = default_config;
+    };
+
+    /**
+      * calculates all jobs using multiple threads
+      * jobs sharing the same DataPoint are grouped together, DataPoints are taken from _shared_storage
+      * @param jobs - vector of jobs
+      * @param pool - thread pool to use
+      * @return vector of Result, i-th Result belongs to i-th job
+      */
+    std::vector<Result> calculate_batch(const std::vector<BatchJob> &jobs, ThreadPool &pool);
+
+    /**
+      * calculates all jobs using multiple threads
+      * @param nthreads - number of threads, 0 means default_thread_pool() is used
+      */
+    std::vector<Result> calculate_batch(const std::vector<BatchJob> &jobs, unsigned int nthreads=0);
+
+    /**
+      * calculates all combinations of projectiles, materials and energies using multiple threads
+      * the result for i-th projectile, j-th material and k-th energy is stored
+      * at index batch_index(i,j,k,materials.size(),energies.size())
+      * @param projectiles - vector of Projectiles
+      * @param materials - vector of Materials including thickness
+      * @param energies - vector of energies in MeV/u
+      * @param pool - thread pool to use
+      * @return dense vector of Result
+      */
+    std::vector<Result> calculate_batch(const std::vector<Projectile> &projectiles,
+                                        const std::vector<Material> &materials,
+                                        const std::vector<double> &energies,
+                                        const Config &c,
+                                        ThreadPool &pool);
+
+    /**
+      * calculates all combinations of projectiles, materials and energies using multiple threads
+      * results are stored to caller provided array res of size projectiles.size()*materials.size()*energies.size(),
+      * the index of the result is given by batch_index(), when the DataPoints are cached the call does not allocate
+      * @param res - output array of Results
+      */
+    void calculate_batch(const std::vector<Projectile> &projectiles,
+                         const std::vector<Material> &materials,
+                         const std::vector<double> &energies,
+                         Result *res,
+                         const Config &c,
+                         ThreadPool &pool);
+
+    /**
+      * calculates all combinations of projectiles, materials and energies using multiple threads
+      * @param nthreads - number of threads, 0 means default_thread_pool() is used
+      */
+    std::vector<Result> calculate_batch(const std::vector<Projectile> &projectiles,
+                                        const std::vector<Material> &materials,
+                                        const std::vector<double> &energies,
+                                        const Config &c=default_config,
+                                        unsigned int nthreads=0);
+
+    /**
+      * calculates all combinations of projectiles and energies passing through the layers using multiple threads
+      * the total Result for i-th projectile and k-th energy is stored to res[i*energies.size()+k],
+      * res must have size projectiles.size()*energies.size()
+      * @param projectiles - vector of Projectiles
+      * @param energies - vector of energies in MeV/u
+      * @param layers - Layers including thickness
+      * @param res - output array of Results
+      * @param pool - thread pool to use
+      */
+    void calculate_batch(const std::vector<Projectile> &projectiles,
+                         const std::vector<double> &energies,
+                         const Layers &layers,
+                         Result *res,
+                         const Config &c,
+                         ThreadPool &pool);
+
+    /**
+      * calculates all combinations of projectiles and energies passing through the layers using multiple threads
+      * @param nthreads - number of threads, 0 means default_thread_pool() is used
+      * @return dense vector of total Results
+      */
+    std::vector<Result> calculate_batch(const std::vector<Projectile> &projectiles,
+                                        const std::vector<double> &energies,
+                                        const Layers &layers,
+                                        const Config &c=default_config,
+                                        unsigned int nthreads=0);
+
+    /// index of the result in the dense array returned by the grid calculate_batch
+    constexpr std::size_t batch_index(std::size_t iprojectile, std::size_t imaterial, std::size_t ienergy,
+                                      std::size_t nmaterials, std::size_t nenergies){
+        return (iprojectile*nmaterials + imaterial)*nenergies + ienergy;
+    }
+
+    /**
+      * returns DataPoints for all projectile-material combinations, calculated in parallel
+      * @return vector of DataPoints, index is iprojectile*materials.size() + imaterial
+      */
+    std::vector<std::shared_ptr<const DataPoint>> get_data_batch(const std::vector<Projectile> &projectiles,
+                                                                  const std::vector<Material> &materials,
+                                                                  const Config &c,
+                                                                  ThreadPool &pool);
+}
+
+#endif
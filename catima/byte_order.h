@@ -0,0 +1,51 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/// \file byte_order.h
+#ifndef CATIMA_BYTE_ORDER_H
+#define CATIMA_BYTE_ORDER_H
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace catima{
+
+    /// true if the host stores numbers in little-endian byte order
+    inline bool host_little_endian(){
+        const std::uint16_t v = 1;
+        unsigned char b;
+        std::memcpy(&b, &v, 1);
+        return b==1;
+    }
+
+    /// returns the value with reversed order of bytes
+    template<typename T>
+    T byte_swap(T v){
+        static_assert(std::is_arithmetic<T>::value, "only numbers can be swapped");
+        unsigned char b[sizeof(T)];
+        std::memcpy(b, &v, sizeof(T));
+        std::reverse(b, b+sizeof(T));
+        std::memcpy(&v, b, sizeof(T));
+        return v;
+    }
+
+    /// converts the value between the host and little-endian order, the conversion is the same in both directions
+    template<typename T>
+    T convert_little_endian(T v){
+        return host_little_endian()?v:byte_swap(v);
+    }
+}
+
+#endif
@@ -1,7 +1,13 @@
 #include <cmath>
 #include <algorithm>
 #include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 #include "catima/calculations.h"
+#include "catima/kernels.h"
 #include "catima/build_config.h"
 #include "catima/constants.h"
 #include "catima/data_ionisation_potential.h"
@@ -10,6 +16,8 @@
 #include "catima/nucdata.h"
 #include "catima/storage.h"
 #include "catima/srim.h"
+#include "catima/lazy_tables.h"
+#include "catima/thread_pool.h"
 #ifdef GLOBAL
 extern "C"
 {
@@ -61,67 +69,39 @@ double dedx_n(const Projectile &p, const Target &t){
     return sn;
 }
 
-double bethek_dedx_e(const Projectile &p,const Material &mat, const Config &c){
-    double w;
-    double sum=0.0;
-    for(int i=0;i<mat.ncomponents();i++){
-        auto t = mat.get_element(i);
-        w = mat.weight_fraction(i);
-        sum += w*bethek_dedx_e(p,t,c,mat.I());
-    }
-    return sum;
-}
-
-double bethek_dedx_e(const Projectile &p, const Target &t, const Config &c, double I){
-    assert(t.Z>0 && p.Z>0);
-    assert(t.A>0 && p.A>0);
-    assert(p.T>0.0);
-    if(p.T==0)return 0.0;
-    double gamma=1.0 + p.T/atomic_mass_unit;
-    double beta2=1.0-1.0/(gamma*gamma);
-    double beta = sqrt(beta2);
-    double zp_eff = z_effective(p,t,c);
-    assert(zp_eff>=0);
-    double Ipot = (I>0.0)?I:ipot(t.Z);
-    assert(Ipot>0);
-    double f1 = dedx_constant*pow(zp_eff,2.0)*t.Z/(beta2*t.A);
-    double f2 = log(2.0*electron_mass*1000000*beta2/Ipot);
-
-    double eta = beta*gamma;
-    if(!(c.corrections&corrections::no_shell_correction) &&  eta>=0.13){ //shell corrections
-        double cor = (+0.422377*pow(eta,-2)
-                    +0.0304043*pow(eta,-4)
-                    -0.00038106*pow(eta,-6))*1e-6*pow(Ipot,2)
-                  +(+3.858019*pow(eta,-2)
-                    -0.1667989*(pow(eta,-4))
-                    +0.00157955*(pow(eta,-6)))*1.0e-9*pow(Ipot,3);
-        f2 = f2 -cor/t.Z;
-    }
-    f2+=2*log(gamma) -beta2;
-
-    double barkas=1.0;
-    if(!(c.corrections&corrections::no_barkas)){
-        barkas = bethek_barkas(zp_eff,eta,t.Z);
-        }
-
-    double delta = bethek_density_effect(beta, t.Z);
-
-    double LS = 0.0;
-    if(!(c.corrections&corrections::no_lindhard)){
-        //double LS = bethek_lindhard(p);
-        LS = precalculated_lindhard(p);
+void dedx_n(const Projectile &p, const Material &mat, const double *T, double *res, std::size_t n){
+    for(std::size_t i=0;i<n;i++)res[i] = 0.0;
+    for(int j=0;j<mat.ncomponents();j++){
+        auto t = mat.get_element(j);
+        double w = mat.weight_fraction(j);
+        double zpowers = pow(p.Z,0.23)+pow(t.Z,0.23);
+        double asum = p.A + t.A;
+        double eps_unit = 32.53*t.A*1000*p.A/(p.Z*t.Z*asum*zpowers); //projectile energy is converted from MeV/u to keV
+        double sn_unit = w*100*8.4621*p.Z*t.Z*p.A*Avogadro/(asum*zpowers*t.A);
+        for(std::size_t i=0;i<n;i++){
+            double epsilon = eps_unit*T[i];
+            double sn;
+            if(epsilon<=0){
+                continue;
+            }
+            else if(epsilon<=30){
+                sn = log1p(1.1383*epsilon)/ (2*(epsilon + 0.01321*pow(epsilon,0.21226) + 0.19593*std::sqrt(epsilon)));
+            }
+            else{
+                sn = log(epsilon)/(2*epsilon);
+            }
+            res[i] += sn_unit*sn;
         }
-    double result  = (f2)*barkas + LS - delta/2.;
-    result *=f1;
-
-    if( (p.T>50000.0) && !(c.corrections&corrections::no_highenergy)){
-        result += pair_production(p,t);
-        result += bremsstrahlung(p,t);
     }
+}
 
-    return result;
+double bethek_dedx_e(const Projectile &p,const Material &mat, const Config &c){
+    return kernels::bethek_dedx_e<RuntimePolicy>(p,mat,c);
 }
 
+double bethek_dedx_e(const Projectile &p, const Target &t, const Config &c, double I){
+    return kernels::bethek_dedx_e<RuntimePolicy>(p,t,c,I);
+}
 
 double bethek_barkas(double zp_eff,double eta, double zt){
     double V2FVA[4]={0.33,0.30,0.26,0.23};
@@ -168,18 +148,131 @@ double bethek_density_effect(double beta, int zt){
 }
 
 
-double bethek_lindhard(const Projectile &p){
-    const double compton=3.05573356675e-3; // 1.18 fm / Compton wavelength
-    double rho = exp(log(p.A)/3.0)*compton;
-    double gamma=1.0 + p.T/atomic_mass_unit;
-    double beta2=1.0-1.0/(gamma*gamma);
-    double beta = sqrt(beta2);
-    double eta = p.Z*fine_structure/beta;
-    double beta_gamma_R = beta*gamma*rho;
+namespace{
+    // projectile quantities of the Lindhard-Sorensen calculation
+    struct LSKinematics{
+        double Z;
+        double rho;
+        double gamma;
+        double beta2;
+        double eta;
+        double beta_gamma_R;
+        explicit LSKinematics(const Projectile &p){
+            const double compton=3.05573356675e-3; // 1.18 fm / Compton wavelength
+            Z = p.Z;
+            rho = exp(log(p.A)/3.0)*compton;
+            gamma=1.0 + p.T/atomic_mass_unit;
+            beta2=1.0-1.0/(gamma*gamma);
+            double beta = sqrt(beta2);
+            eta = p.Z*fine_structure/beta;
+            beta_gamma_R = beta*gamma*rho;
+        }
+    };
+
+    // phase shift of the partial wave k including finite nuclear size
+    double ls_phase_shift(double k, const LSKinematics &kin){
+        const double rho = kin.rho;
+        const double gamma = kin.gamma;
+        const double eta = kin.eta;
+        const double beta_gamma_R = kin.beta_gamma_R;
+        double l = (k>0)?k:-k-1.0;
+        double signk = (k>0)?1:((k<0)?-1:0);
+        double sk = sqrt(k*k-fine_structure*fine_structure*kin.Z*kin.Z);
+        std::complex<double> cexir_n (k,-eta/gamma);
+        std::complex<double> cexir_den (sk,-eta);
+        std::complex<double> cexir = std::sqrt(cexir_n/cexir_den);
+        std::complex<double> csketa (sk + 1.0, eta);
+        std::complex<double> lngamma_csketa = lngamma(csketa);
+        std::complex<double> cpiske(0.0,(PI*(l-sk)/2.0) - lngamma_csketa.imag());
+        std::complex<double> cedr = cexir*std::exp(cpiske);
+        double H=0;
+
+        // finite struct part
+        std::complex<double> cmsketa (-sk + 1.0, eta);
+        std::complex<double> lngamma_cmsketa = lngamma(cmsketa);
+        std::complex<double> cexis_den (-sk,-eta);
+        std::complex<double> cexis = std::sqrt(cexir_n/cexis_den);
+        std::complex<double> cpimske(0.0,(PI*(l+sk)/2.0) - lngamma_cmsketa.imag());
+        std::complex<double> ceds = cexis*std::exp(cpimske);
+        std::complex<double> cmbeta_gamma_R(0,-beta_gamma_R);
+        std::complex<double> c2beta_gamma_R(0,2.0*beta_gamma_R);
+        std::complex<double> c2sk_1 (2.0*sk+1,0);
+        std::complex<double> cm2sk_1 (-2.0*sk+1,0);
+        std::complex<double> clambda_r = cexir*std::exp(cmbeta_gamma_R)*hyperg(csketa,c2sk_1,c2beta_gamma_R);
+        std::complex<double> clambda_s = cexis*std::exp(cmbeta_gamma_R)*hyperg(cmsketa,cm2sk_1,c2beta_gamma_R);
+        std::complex<double> cGrGs = lngamma(cm2sk_1);
+        double GrGs = clambda_r.imag()/clambda_s.imag();
+        GrGs *= exp( lngamma_csketa.real()
+                     - lngamma_cmsketa.real()
+                     - lngamma(c2sk_1).real()
+                     + cGrGs.real()
+                     + 2.0*sk*log(2.0*beta_gamma_R));
+        if(cos(cGrGs.imag()) < 1.0)GrGs*=-1;
+        if(fabs(GrGs)>1.0e-9){
+            double FrGr = sqrt((gamma-1)/(gamma+1)) * clambda_r.real()/clambda_r.imag();
+            double FsGs = sqrt((gamma-1)/(gamma+1)) * clambda_s.real()/clambda_s.imag();
+            double gz = -1.0*signk*(rho*gamma + 1.5*kin.Z*fine_structure);
+            double z1 = -1.0*signk*kin.Z;
+            double b0 = 1.0;
+            double a0 = (1.0 + 2.0*fabs(k))*b0/(rho-gz);
+            double a1 = 0.5*(gz+rho)*b0;
+            double an = a1;
+            double anm1 = a0;
+            double bnm1 = b0;
+            double asum = a0;
+            double bsum = b0;
+            double nn = 1.0;
+            while(fabs(anm1/asum)>1e-6){
+                double bn = ((rho-gz)*an + fine_structure*z1*anm1/2.0)/(2.0*nn+2.0*fabs(k)+1.0);
+                double anp1 = ((gz+rho)*bn - fine_structure*z1*bnm1/2.0)/(2.0*nn + 2.0);
+                asum += an;
+                bsum += bn;
+                nn += 1.0;
+                anm1 = an;
+                an = anp1;
+                bnm1 = bn;
+            }
+            double figi= (k>0) ? asum/bsum : bsum/asum;
+            H = (FrGr - figi)/(figi-FsGs)* GrGs;
+        }
+
+        return std::arg(cedr + H*ceds);
+    }
+
+    // termination of the partial wave sums, asymptotically the terms decrease as c/k^2
+    // and the remainder after the k-th term is estimated as k*term and added to the sum.
+    // The sum is stopped when the estimated remainder is below tolerance and k^2*term
+    // is constant within 1% for ls_stable_partial_waves consecutive partial waves
+    struct LSTermination{
+        double tolerance;
+        int count = 0;
+        double last = 0.0;
+        explicit LSTermination(double tol):tolerance(tol){}
+        bool operator()(double k, double term, double &sum){
+            if(!(tolerance>0.0))return false;
+            const double c = k*k*term;
+            if(k>ls_min_partial_waves && std::abs(c-last)<0.01*std::abs(c) && std::abs(term)*k<tolerance){
+                count++;
+            }
+            else{
+                count = 0;
+            }
+            last = c;
+            if(count<ls_stable_partial_waves)return false;
+            sum += k*term;
+            return true;
+        }
+    };
+}
+
+double bethek_lindhard(const Projectile &p, double tolerance){
+    LSKinematics kin(p);
+    const double eta = kin.eta;
     double sum = 0;
     int n=1;
+    LSTermination converged(tolerance);
 
-    if(gamma < 10.0/rho){
+    if(kin.gamma < 10.0/kin.rho){
         double dk[3];
         double dmk = 0;
         double dkm1 = 0;
@@ -190,71 +283,7 @@ double bethek_lindhard(const Projectile &p){
                 double k = k0;
                 if(i==1)k=-k0 - 1.0;
                 if(i==2)k=-k0;
-                double l = (k>0)?k:-k-1.0;
-                double signk = (k>0)?1:((k<0)?-1:0);
-                double sk = sqrt(k*k-fine_structure*fine_structure*p.Z*p.Z);
-                std::complex<double> cexir_n (k,-eta/gamma);
-                std::complex<double> cexir_den (sk,-eta);
-                std::complex<double> cexir = std::sqrt(cexir_n/cexir_den);
-                std::complex<double> csketa (sk + 1.0, eta);
-                std::complex<double> cpiske(0.0,(PI*(l-sk)/2.0) - lngamma(csketa).imag());
-                std::complex<double> cedr = cexir*std::exp(cpiske);
-                double H=0;
-
-                //std::complex<double> ceds(0.0,0.0);
-                // finite struct part
-                std::complex<double> cmsketa (-sk + 1.0, eta);
-                std::complex<double> cexis_den (-sk,-eta);
-                std::complex<double> cexis = std::sqrt(cexir_n/cexis_den);
-                std::complex<double> cpimske(0.0,(PI*(l+sk)/2.0) - lngamma(cmsketa).imag());
-                std::complex<double> ceds = cexis*std::exp(cpimske);
-                std::complex<double> cmbeta_gamma_R(0,-beta_gamma_R);
-                std::complex<double> c2beta_gamma_R(0,2.0*beta_gamma_R);
-                std::complex<double> c2sk_1 (2.0*sk+1,0);
-                std::complex<double> cm2sk_1 (-2.0*sk+1,0);
-                std::complex<double> clambda_r = cexir*std::exp(cmbeta_gamma_R)*hyperg(csketa,c2sk_1,c2beta_gamma_R);
-                std::complex<double> clambda_s = cexis*std::exp(cmbeta_gamma_R)*hyperg(cmsketa,cm2sk_1,c2beta_gamma_R);
-                std::complex<double> cGrGs = lngamma(cm2sk_1);
-                double GrGs = clambda_r.imag()/clambda_s.imag();
-                GrGs *= exp( lngamma(csketa).real()
-                             - lngamma(cmsketa).real()
-                             - lngamma(c2sk_1).real()
-                             + cGrGs.real()
-                             + 2.0*sk*log(2.0*beta_gamma_R));
-                if(cos(cGrGs.imag()) < 1.0)GrGs*=-1;
-                if(fabs(GrGs)>1.0e-9){
-                    double FrGr = sqrt((gamma-1)/(gamma+1)) * clambda_r.real()/clambda_r.imag();
-                    double FsGs = sqrt((gamma-1)/(gamma+1)) * clambda_s.real()/clambda_s.imag();
-                    double gz = -1.0*signk*(rho*gamma + 1.5*p.Z*fine_structure);
-                    double z1 = -1.0*signk*p.Z;
-                    double b0 = 1.0;
-                    double a0 = (1.0 + 2.0*fabs(k))*b0/(rho-gz);
-                    double a1 = 0.5*(gz+rho)*b0;
-                    double an = a1;
-                    double anm1 = a0;
-                    double bnm1 = b0;
-                    double asum = a0;
-                    double bsum = b0;
-                    double nn = 1.0;
-                    while(fabs(anm1/asum)>1e-6 && fabs(anm1/asum)>1e-6){
-                        double bn = ((rho-gz)*an + fine_structure*z1*anm1/2.0)/(2.0*nn+2.0*fabs(k)+1.0);
-                        double anp1 = ((gz+rho)*bn - fine_structure*z1*bnm1/2.0)/(2.0*nn + 2.0);
-                        asum += an;
-                        bsum += bn;
-                        nn += 1.0;
-                        anm1 = an;
-                        an = anp1;
-                        bnm1 = bn;
-                    }
-                    double figi= (k>0) ? asum/bsum : bsum/asum;
-                    H = (FrGr - figi)/(figi-FsGs)* GrGs;
-
-                }
-                else
-                    H = 0;
-
-
-                dk[i] = std::arg(cedr + H*ceds);
+                dk[i] = ls_phase_shift(k, kin);
             }
             if(n>1)dk[2] = dmk;
 
@@ -271,28 +300,29 @@ double bethek_lindhard(const Projectile &p){
             n += 1;
             dmk = dk[1];
             dkm1 = dk[0];
-
-        }// end of while n<100
+            if(converged(k0, term2 + term3, sum))break;
+        }
 
     }
     else{ // ultrarelativistic limit
-        sum = -log(beta_gamma_R) - 0.2;
+        sum = -log(kin.beta_gamma_R) - 0.2;
     }
-    return sum + (0.5*beta2);
+    return sum + (0.5*kin.beta2);
 }
 
-double bethek_lindhard_X(const Projectile &p){
-    const double compton=3.05573356675e-3; // 1.18 fm / Compton wavelength
-    double rho = exp(log(p.A)/3.0)*compton;
-    double gamma=1.0 + p.T/atomic_mass_unit;
-    double beta2=1.0-1.0/(gamma*gamma);
-    double beta = sqrt(beta2);
-    double eta = p.Z*fine_structure/beta;
-    double beta_gamma_R = beta*gamma*rho;
-    double sum = 0;
-    int n=1;
+double bethek_lindhard(const Projectile &p){
+    return bethek_lindhard(p, 0.0);
+}
+
+namespace{
+    // straggling correction X for already calculated L correction
+    double lindhard_X(const Projectile &p, double L, double tolerance){
+        LSKinematics kin(p);
+        const double eta = kin.eta;
+        double sum = 0;
+        int n=1;
+        LSTermination converged(tolerance);
 
-    if(1){
         double dk[4];
         double dmk = 0;
         double dmkp1 = 0;
@@ -301,78 +331,13 @@ double bethek_lindhard_X(const Projectile &p){
 
         while(n<1000){
             double k0 = n;
-            //int max = (n==1)?4:2;
             int max = 4;
             for(int i=0;i<max;i++){
                 double k=k0;
                 if(i==1)k=-k0 - 1.0;
                 if(i==2 && n==1)k=-k0;
                 if(i==3)k=-k0 - 2.0;
-                double l = (k>0)?k:-k-1.0;
-                double signk = (k>0)?1:((k<0)?-1:0);
-                double sk = sqrt(k*k-fine_structure*fine_structure*p.Z*p.Z);
-                std::complex<double> cexir_n (k,-eta/gamma);
-                std::complex<double> cexir_den (sk,-eta);
-                std::complex<double> cexir = std::sqrt(cexir_n/cexir_den);
-                std::complex<double> csketa (sk + 1.0, eta);
-                std::complex<double> cpiske(0.0,(PI*(l-sk)/2.0) - lngamma(csketa).imag());
-                std::complex<double> cedr = cexir*std::exp(cpiske);
-                double H=0;
-
-                //std::complex<double> ceds(0.0,0.0);
-                // finite struct part
-                std::complex<double> cmsketa (-sk + 1.0, eta);
-                std::complex<double> cexis_den (-sk,-eta);
-                std::complex<double> cexis = std::sqrt(cexir_n/cexis_den);
-                std::complex<double> cpimske(0.0,(PI*(l+sk)/2.0) - lngamma(cmsketa).imag());
-                std::complex<double> ceds = cexis*std::exp(cpimske);
-                std::complex<double> cmbeta_gamma_R(0,-beta_gamma_R);
-                std::complex<double> c2beta_gamma_R(0,2.0*beta_gamma_R);
-                std::complex<double> c2sk_1 (2.0*sk+1,0);
-                std::complex<double> cm2sk_1 (-2.0*sk+1,0);
-                std::complex<double> clambda_r = cexir*std::exp(cmbeta_gamma_R)*hyperg(csketa,c2sk_1,c2beta_gamma_R);
-                std::complex<double> clambda_s = cexis*std::exp(cmbeta_gamma_R)*hyperg(cmsketa,cm2sk_1,c2beta_gamma_R);
-                std::complex<double> cGrGs = lngamma(cm2sk_1);
-                double GrGs = clambda_r.imag()/clambda_s.imag();
-                GrGs *= exp( lngamma(csketa).real()
-                             - lngamma(cmsketa).real()
-                             - lngamma(c2sk_1).real()
-                             + cGrGs.real()
-                             + 2.0*sk*log(2.0*beta_gamma_R));
-                if(cos(cGrGs.imag()) < 1.0)GrGs*=-1;
-                if(fabs(GrGs)>1.0e-9){
-                    double FrGr = sqrt((gamma-1)/(gamma+1)) * clambda_r.real()/clambda_r.imag();
-                    double FsGs = sqrt((gamma-1)/(gamma+1)) * clambda_s.real()/clambda_s.imag();
-                    double gz = -1.0*signk*(rho*gamma + 1.5*p.Z*fine_structure);
-                    double z1 = -1.0*signk*p.Z;
-                    double b0 = 1.0;
-                    double a0 = (1.0 + 2.0*fabs(k))*b0/(rho-gz);
-                    double a1 = 0.5*(gz+rho)*b0;
-                    double an = a1;
-                    double anm1 = a0;
-                    double bnm1 = b0;
-                    double asum = a0;
-                    double bsum = b0;
-                    double nn = 1.0;
-                    while(fabs(anm1/asum)>1e-6 ){
-                        double bn = ((rho-gz)*an + fine_structure*z1*anm1/2.0)/(2.0*nn+2.0*fabs(k)+1.0);
-                        double anp1 = ((gz+rho)*bn - fine_structure*z1*bnm1/2.0)/(2.0*nn + 2.0);
-                        asum += an;
-                        bsum += bn;
-                        nn += 1.0;
-                        anm1 = an;
-                        an = anp1;
-                        bnm1 = bn;
-                    }
-                    double figi= (k>0) ? asum/bsum : bsum/asum;
-                    H = (FrGr - figi)/(figi-FsGs)* GrGs;
-
-                }
-                else
-                    H = 0;
-
-
-                dk[i] = std::arg(cedr + H*ceds);
+                dk[i] = ls_phase_shift(k, kin);
             }
             if(n>1)dk[2] = dmk;
 
@@ -398,24 +363,27 @@ double bethek_lindhard_X(const Projectile &p){
             double sdd = sin(dk[0]-dk[1]);
             strterm3 = sdd*sdd*(k0+1.0)*((1/(4.0*k0*k0 -1.0))+(1/(4*(k0+1.0)*(k0+1.0) - 1.0)))/(2.0*k0 + 1.0);
 
-            //sum += k0*(strterm1p + strterm1n + (strterm2*2) + strterm3)/eta2;
-            sum += k0*(strterm1p + strterm1n + (strterm2*2) + strterm3)/eta2;
-            sum += - (2.0/k0);
-            //std::cout<<n<<" "<<strterm1p<<" "<<strterm1n<<" "<<strterm2<<" "<<strterm3<<" "<<sum<<std::endl;
+            double term = k0*(strterm1p + strterm1n + (strterm2*2) + strterm3)/eta2 - (2.0/k0);
+            sum += term;
             n += 1;
             dmk = dk[1];
             dkm2 = dkm1;
             dkm1 = dk[0];
             dmkp1 = dk[2];
+            if(converged(k0, term, sum))break;
+        }
 
-        }// end of while n<100
-
+        double res = 2*L - sum - kin.beta2;
+        return (res>=0)?res:0.0;
     }
-    else{ // ultrarelativistic limit
+}
 
-    }
-    double res = 2*bethek_lindhard(p) - sum - beta2;
-    return (res>=0)?res:0.0;
+double bethek_lindhard_X(const Projectile &p, double tolerance){
+    return lindhard_X(p, bethek_lindhard(p, tolerance), tolerance);
+}
+
+double bethek_lindhard_X(const Projectile &p){
+    return bethek_lindhard_X(p, 0.0);
 }
 
 double pair_production(const Projectile &p, const Target &t){
@@ -451,7 +419,11 @@ double sezi_dedx_e(const Projectile &p, const Material &mat, const Config &c){
     for(int i=0;i<mat.ncomponents();i++){
         auto t = mat.get_element(i);
         w = mat.weight_fraction(i);
+#ifdef SRIM_TABLES
+        sum += w*srim_dedx_e_tabulated(p.Z,t.Z,T, use95)/t.A;
+#else
         sum += w*srim_dedx_e(p.Z,t.Z,T, use95)/t.A;
+#endif
     }
     return 100*sum*Avogadro; // returning MeV/g/cm2
 }
@@ -577,11 +549,77 @@ double scattering_length(const Material& material){
 }
 
 
+namespace{
+    // number of Z rows of the generated coefficients
+    constexpr int ls_generated_max_z = std::extent<decltype(ls_coefficients::ls_coefficients_a)>::value;
+
+    // L and X corrections of the single projectile on the ls_energy_table grid
+    struct LSProjectileTable{
+        double L[decltype(ls_coefficients::ls_energy_table)::size()];
+        double X[decltype(ls_coefficients::ls_energy_table)::size()];
+    };
+
+    // returns the table of the projectile, the table is calculated on the first use
+    // the last ls_max_tables tables are kept, the returned pointer stays valid if the table is replaced
+    std::shared_ptr<LSProjectileTable> ls_projectile_table(double Z, double A){
+        static std::mutex mutex;
+        static std::vector<std::pair<std::pair<double,double>, std::shared_ptr<LSProjectileTable>>> tables;
+        static std::size_t index = 0;
+        const auto key = std::make_pair(Z,A);
+        auto find = [&key]()->std::shared_ptr<LSProjectileTable>{
+            for(auto &e:tables){
+                if(e.first==key)return e.second;
+            }
+            return nullptr;
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(auto t = find())return t;
+        }
+
+        // no lock is held while calculating, concurrent first requests may calculate the same table
+        auto t = std::make_shared<LSProjectileTable>();
+        default_thread_pool().parallel_for(ls_coefficients::ls_energy_table.size(), [&t,Z,A](std::size_t i){
+            Projectile p(A,Z);
+            p.T = ls_coefficients::ls_energy_table(i);
+            t->L[i] = bethek_lindhard(p, ls_table_tolerance);
+            t->X[i] = lindhard_X(p, t->L[i], ls_table_tolerance);
+            }, 1);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(auto stored = find())return stored;
+        if(tables.size()<ls_max_tables){
+            tables.emplace_back(key, t);
+        }
+        else{
+            tables[index] = std::make_pair(key, t);
+            index = (index+1)%ls_max_tables;
+        }
+        return t;
+    }
+
+    // true if the projectile is not covered by the generated coefficients
+    bool ls_outside_generated(const Projectile &p){
+        if(p.Z>ls_generated_max_z)return true;
+        int z = (int)p.Z;
+        if(z<1)return false;
+        double da = (p.A - element_atomic_weight(z))/element_atomic_weight(z);
+        return da < ls_mass_window_low || da > ls_mass_window_high;
+    }
+
+    // the exact corrections are defined for Z*alpha<1, heavier projectiles use Z=ls_max_exact_z
+    double ls_exact_z(double Z){
+        return std::min(Z, ls_max_exact_z);
+    }
+}
+
 double precalculated_lindhard(const Projectile &p){
     double T = p.T;
     int z = (int)p.Z ;
-    if(z>LS_MAX_Z)z=LS_MAX_Z;
     if(p.T<ls_coefficients::ls_energy_table(0))T=ls_coefficients::ls_energy_table(0);
+    if(ls_outside_generated(p)){
+        return EnergyTable_interpolate(ls_coefficients::ls_energy_table,T,ls_projectile_table(ls_exact_z(p.Z),p.A)->L);
+    }
 
     double da = (p.A - element_atomic_weight(z))/element_atomic_weight(z);
     z = z-1;
@@ -598,9 +636,11 @@ double precalculated_lindhard(const Projectile &p){
 double precalculated_lindhard_X(const Projectile &p){
     double T = p.T;
     int z = (int)p.Z ;
-    if(z>LS_MAX_Z)z=LS_MAX_Z;
     //if(p.T<ls_coefficients::ls_energy_table(0))T=ls_coefficients::ls_energy_table(0);
     if(p.T<ls_coefficients::ls_energy_table(0))return 1.0;
+    if(ls_outside_generated(p)){
+        return EnergyTable_interpolate(ls_coefficients::ls_energy_table,T,ls_projectile_table(ls_exact_z(p.Z),p.A)->X);
+    }
     double da = (p.A - element_atomic_weight(z))/element_atomic_weight(z);
     z = z-1;
 
@@ -614,60 +654,49 @@ double precalculated_lindhard_X(const Projectile &p){
 }
 
 double dedx_variance(const Projectile &p, const Target &t, const Config &c){
-    double gamma = gamma_from_T(p.T);
-    double cor=0;
-    double beta = beta_from_T(p.T);
-    double beta2 = beta*beta;
-    double zp_eff = z_effective(p,t,c);
-    double f = domega2dx_constant*ipow(zp_eff,2)*t.Z/t.A;
-
-    if( (c.calculation == omega_types::atima) ){
-        cor = 24.89 * std::pow(t.Z,1.2324)/(electron_mass*1e6 * beta2)*
-			log( 2.0*electron_mass*1e6*beta2/(33.05*std::pow(t.Z,1.6364)));
-	    cor = std::max(cor, 0.0 );
-    }
-	//double X = bethek_lindhard_X(p);
-    double X = precalculated_lindhard_X(p);
-    X *= gamma*gamma;
-    if(p.T<30.0)
-		return std::min(f*(X+cor), energy_straggling_firsov(p.Z, p.T, t.Z,t.A));
-	else
-		return f*(X+cor);
+    return kernels::dedx_variance<RuntimePolicy>(p,t,c);
 }
 
 double z_effective(const Projectile &p,const Target &t, const Config &c){
-    if(c.z_effective == z_eff_type::none){
-        return p.Q;
-    }
+    return kernels::z_effective<RuntimePolicy>(p,t,c);
+}
 
-    double gamma=1.0 + p.T/atomic_mass_unit;
-    double beta = sqrt(1.0-1.0/(gamma*gamma));
-    if(c.z_effective == z_eff_type::pierce_blann){
-        return z_eff_Pierce_Blann(p.Z, beta);
-    }
-    else if(c.z_effective == z_eff_type::anthony_landorf){
-        return z_eff_Anthony_Landford(p.Z, beta, t.Z);
+namespace{
+    constexpr int zeff_table_maxz = 92;
+    constexpr int zeff_table_models = z_eff_type::atima14+1;
+
+    double z_eff_model(unsigned char type, double pz, double E, double tz){
+        const double beta = beta_from_T(E);
+        switch(type){
+            case z_eff_type::pierce_blann: return z_eff_Pierce_Blann(pz, beta);
+            case z_eff_type::anthony_landorf: return z_eff_Anthony_Landford(pz, beta, tz);
+            case z_eff_type::hubert: return z_eff_Hubert(pz, E, tz);
+            case z_eff_type::winger: return z_eff_Winger(pz, beta, tz);
+            case z_eff_type::global: return z_eff_global(pz, E, tz);
+            case z_eff_type::atima14: return z_eff_atima14(pz, E, tz);
+            case z_eff_type::schiwietz: return z_eff_Schiwietz(pz, beta, tz);
+            default:
+                assert(false);
+                return 0.0;
+        }
     }
 
-    else if(c.z_effective == z_eff_type::hubert){
-        return z_eff_Hubert(p.Z, p.T, t.Z);
-    }
-    else if(c.z_effective == z_eff_type::winger){
-        return z_eff_Winger(p.Z, beta, t.Z);
-    }
-    else if(c.z_effective == z_eff_type::global){
-        return z_eff_global(p.Z, p.T, t.Z);
-    }
-    else if(c.z_effective == z_eff_type::atima14){
-        return z_eff_atima14(p.Z, p.T, t.Z);
-    }
-    else if(c.z_effective == z_eff_type::schiwietz){
-        return z_eff_Schiwietz(p.Z, beta, t.Z);
+    const LazyLogTables& zeff_tables(){
+        static const LazyLogTables tables(zeff_table_models*zeff_table_maxz*zeff_table_maxz, logEmin, logEmax,
+                                          zeff_table_points, zeff_table_tolerance);
+        return tables;
     }
-    else{
-        assert(false);
-        return 0.0;
+}
+
+double z_eff_tabulated(unsigned char type, double pz, double E, double tz){
+    const int ipz = static_cast<int>(pz);
+    const int itz = static_cast<int>(tz);
+    if(type<z_eff_type::pierce_blann || type>=zeff_table_models
+       || ipz!=pz || itz!=tz || ipz<1 || itz<1 || ipz>zeff_table_maxz || itz>zeff_table_maxz){
+        return z_eff_model(type, pz, E, tz);
     }
+    std::size_t i = (static_cast<std::size_t>(type)*zeff_table_maxz + ipz-1)*zeff_table_maxz + itz-1;
+    return zeff_tables()(i, E, [&](double e){return z_eff_model(type, pz, e, tz);});
 }
 
 double z_eff_Pierce_Blann(double z, double beta){
@@ -17,6 +17,7 @@
 #ifndef CALCULATIONS_H
 #define CALCULATIONS_H
 #include <complex>
+#include <cstddef>
 #include "catima/structures.h"
 #include "catima/config.h"
 
@@ -27,6 +28,11 @@ namespace catima{
       */
     double dedx_n(const Projectile &p, const Target &t);
     double dedx_n(const Projectile &p, const Material &mat); 
+
+    /**
+      * nuclear stopping power for n energies T, results are stored to res
+      */
+    void dedx_n(const Projectile &p, const Material &mat, const double *T, double *res, std::size_t n);
     
     /**
       * returns energy loss straggling
@@ -61,11 +67,24 @@ namespace catima{
       */
     double bethek_lindhard(const Projectile &p);
 
+    /**
+      * calculates lindhard correction for energy loss calculation
+      * the partial wave sum is terminated when the estimated remainder is below tolerance
+      * @param tolerance - absolute tolerance of the sum, 0 sums all partial waves
+      */
+    double bethek_lindhard(const Projectile &p, double tolerance);
+
     /**
       * calculates lindhard correction for energy loss straggling calculation
       */
     double bethek_lindhard_X(const Projectile &p);
 
+    /**
+      * calculates lindhard correction for energy loss straggling calculation
+      * @param tolerance - absolute tolerance of the partial wave sums, 0 sums all partial waves
+      */
+    double bethek_lindhard_X(const Projectile &p, double tolerance);
+
     /**
       * calculates pair production stopping power
       */
@@ -154,6 +173,19 @@ namespace catima{
       */ 
     double z_effective(const Projectile &p, const Target &t, const Config &c=default_config);
 
+    /**
+      * calculates effective charge from the table of the projectile Z, target Z and model
+      * the tables are calculated on the first use on logarithmic energy grid and interpolated linearly,
+      * the relative interpolation error is below zeff_table_tolerance, grid cells where it is not
+      * fulfilled and non integer or Z above 92 are calculated directly
+      * @param type - effective charge model, z_eff_type
+      * @param pz - proton number of projectile
+      * @param E - energy in MeV/u
+      * @param tz - proton number of target
+      * @return - z effective
+      */
+    double z_eff_tabulated(unsigned char type, double pz, double E, double tz);
+
     /**
       * calculates effective charge
       * @param z - proton number of projectile
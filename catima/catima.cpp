@@ -1,6 +1,12 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include "catima/catima.h"
 #include "catima/constants.h"
 #include "catima/data_ionisation_potential.h"
@@ -9,6 +15,7 @@
 #include "catima/storage.h"
 #include "catima/nucdata.h"
 #include "catima/calculations.h"
+#include "catima/kernels.h"
 #ifdef REACTIONS
 #include "catima/reactions.h"
 #endif
@@ -27,34 +34,39 @@ bool operator==(const Config &a, const Config&b){
 
 
 double dedx(const Projectile &p, const Material &mat, const  Config &c){
-    double sum = 0;
-    if(p.T<=0)return 0.0;
-    sum += dedx_n(p,mat);
-    double se=0;
-    if(p.T<=10){
-        se = sezi_dedx_e(p,mat,c );
-    }
-    else if(p.T>10 && p.T<30){
-        double factor = 0.05 * ( p.T - 10.0 );
-        se = (1-factor)*sezi_dedx_e(p,mat,c) + factor*bethek_dedx_e(p,mat,c);
-    }
-    else {
-        se = bethek_dedx_e(p,mat,c);
-    }
-    sum+=se;
-
-    return sum;
+    return dispatch_config(c, [&](auto policy){
+        return kernels::dedx<decltype(policy)>(p,mat,c);
+        });
 }
 
 double domega2dx(const Projectile &p, const Material &mat, const Config &c){
-    double sum = 0;
-    
-    for(int i=0;i<mat.ncomponents();i++){
-        auto t= mat.get_element(i);
-        double w = mat.weight_fraction(i);
-        sum += w*dedx_variance(p,t,c);
-    }
-    return sum;
+    return dispatch_config(c, [&](auto policy){
+        return kernels::domega2dx<decltype(policy)>(p,mat,c);
+        });
+}
+
+void dedx(const Projectile &p, const Material &mat, const double *T, double *res, std::size_t n, const Config &c){
+    dispatch_config(c, [&](auto policy){
+        kernels::dedx<decltype(policy)>(p,mat,c,T,res,n);
+        });
+}
+
+std::vector<double> dedx(const Projectile &p, const std::vector<double> &T, const Material &mat, const Config &c){
+    std::vector<double> res(T.size());
+    dedx(p,mat,T.data(),res.data(),T.size(),c);
+    return res;
+}
+
+void domega2dx(const Projectile &p, const Material &mat, const double *T, double *res, std::size_t n, const Config &c){
+    dispatch_config(c, [&](auto policy){
+        kernels::domega2dx<decltype(policy)>(p,mat,c,T,res,n);
+        });
+}
+
+std::vector<double> domega2dx(const Projectile &p, const std::vector<double> &T, const Material &mat, const Config &c){
+    std::vector<double> res(T.size());
+    domega2dx(p,mat,T.data(),res.data(),T.size(),c);
+    return res;
 }
 
 double range(const Projectile &p, const Material &t, const Config &c){
@@ -71,20 +83,22 @@ double dedx_from_range(const Projectile &p, const Material &t, const Config &c){
     return p.A/range_spline.derivative(p.T);
 }
 
-std::vector<double> dedx_from_range(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c){
+void dedx_from_range(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c){
     auto& data = _storage.Get(p,t,c);
-    //Interpolator range_spline(energy_table.values,data.range.data(),energy_table.num);
     spline_type range_spline = get_range_spline(data);
-    std::vector<double> dedx;
-    dedx.reserve(T.size());
-    for(auto e:T){
-        if(e<catima::Ezero){
-            dedx.push_back(0.0);
+    for(std::size_t i=0;i<n;i++){
+        if(T[i]<catima::Ezero){
+            res[i] = 0.0;
         }
         else{
-            dedx.push_back(p.A/range_spline.derivative(e));
+            res[i] = p.A/range_spline.derivative(T[i]);
         }
     }
+}
+
+std::vector<double> dedx_from_range(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c){
+    std::vector<double> dedx(T.size());
+    dedx_from_range(p,t,T.data(),dedx.data(),T.size(),c);
     return dedx;
 }
 
@@ -137,13 +151,18 @@ double Tfr(const Projectile &p, double X, double Es2){
 }
 
 double angular_variance(Projectile p, const Material &t, const Config &c, int order){
-    const double T = p.T;    
+    auto& data = _storage.Get(p,t,c);
+    return angular_variance(data, p.T, t, order);
+}
+
+double angular_variance(const DataPoint &data, double T, const Material &t, int order){
+    const Projectile &p = data.p;
+    const Config &c = data.config;
     const double p1 = p_from_T(T,p.A);
     const double beta1 = p1/((T+atomic_mass_unit)*p.A);    
     assert(T>0.0);
     assert(t.density()>0.0);
     assert(t.thickness()>0.0);    
-    auto& data = _storage.Get(p,t,c);    
     spline_type range_spline = get_range_spline(data);    
     double range = range_spline(T);    
     double rrange = std::min(range/t.density(), t.thickness_cm()); // residual range, in case of stopping inside material
@@ -151,6 +170,7 @@ double angular_variance(Projectile p, const Material &t, const Config &c, int or
     double Es2 = 198.81;
     if(c.scattering == scattering_types::dhighland)Es2 = 15*15;
     if(c.scattering == scattering_types::fermi_rossi)Es2 = 15*15;
+    Projectile pe = p;
 
     auto fx0p = [&](double x)->double{         
         double e =energy_out(T,x*t.density(),range_spline);
@@ -162,13 +182,13 @@ double angular_variance(Projectile p, const Material &t, const Config &c, int or
             ff = 0.97*(1+lnl/20.7)*(1+lnl/22.7);
         }
 	    //return d*ff*da2dx(p(e), t, c);
-        return d*ff*Tfr(p(e),1, 1.0);
+        return d*ff*Tfr(pe(e),1, 1.0);
             };
 
     auto fx0p_2 = [&](double x)->double{         
         double e =energy_out(T,x*t.density(),range_spline);                
         double d = ipow((rrange-x),order);
-        return d*angular_scattering_power_xs(p(e),t,p1,beta1);
+        return d*angular_scattering_power_xs(pe(e),t,p1,beta1);
             };
     
     // corrections      
@@ -182,12 +202,13 @@ double angular_straggling(Projectile p, const Material &t, const Config &c){
     return sqrt(angular_variance(p,t,c));
 }
 
-double angular_straggling_from_E(const Projectile &p, double Tout, Material t, const Config &c){
+double angular_straggling_from_E(const Projectile &p, double Tout, const Material &t, const Config &c){
     auto& data = _storage.Get(p,t,c);
     spline_type range_spline = get_range_spline(data);    
     double th = range_spline(p.T)-range_spline(Tout);    
-    t.thickness(th);
-    return angular_straggling(p,t,c);
+    Material m = t; // copy of Material with inline elements does not allocate
+    m.thickness(th);
+    return angular_straggling(p,m,c);
 }
 
 double energy_straggling_from_E(const Projectile &p, double T, double Tout,const Material &t, const Config &c){
@@ -230,26 +251,95 @@ double energy_out(const Projectile &p, const Material &t, const Config &c){
     return energy_out(p.T,t.thickness(),range_spline);
     }
 
-std::vector<double> energy_out(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c){
+void energy_out(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c){
     auto& data = _storage.Get(p,t,c);
-    //Interpolator range_spline(energy_table.values,data.range.data(),energy_table.num);
     spline_type range_spline = get_range_spline(data);
-
-    std::vector<double> eout;
-    eout.reserve(T.size());
-    for(auto e:T){
-        if(e<catima::Ezero){
-            eout.push_back(0.0);
+    for(std::size_t i=0;i<n;i++){
+        if(T[i]<catima::Ezero){
+            res[i] = 0.0;
         }
         else{
-            eout.push_back(energy_out(e,t.thickness(),range_spline));
+            res[i] = energy_out(T[i],t.thickness(),range_spline);
         }
     }
-    
+    }
+
+std::vector<double> energy_out(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c){
+    std::vector<double> eout(T.size());
+    energy_out(p,t,T.data(),eout.data(),T.size(),c);
     return eout;
     }
 
+double energy_in(double T, double thickness, const Interpolator &range_spline){
+    int counter = 0;
+    double e,r;
+    if(thickness<=0.0)return T;
+    if(T>=range_spline.get_max())return -1;
+
+    // R(Ein) = R(Eout) + thickness
+    const double range = range_spline(T) + thickness;
+    if(range>range_spline(range_spline.get_max()))return -1;
+    double dedx = 1.0/range_spline.derivative(T);
+    e = T + (thickness*dedx);
+    if(e>range_spline.get_max())e = 0.5*(T+range_spline.get_max());
+    while(1){
+        r = range_spline(e) - range;
+        if(fabs(r)<Eout_th_epsilon)return e;
+        dedx = 1.0/range_spline.derivative(e);
+        double step = r*dedx;
+        e = e-step;
+        if(e<=T)e = 0.5*(T+e+step); // keep above outcoming energy
+        counter++;
+        assert(counter<=100);
+        if(counter>100)return -1;
+    }
+    return -1;
+}
+
+double energy_in(const Projectile &p, const Material &t, const Config &c){
+    auto& data = _storage.Get(p,t,c);
+    spline_type range_spline = get_range_spline(data);
+    return energy_in(p.T,t.thickness(),range_spline);
+    }
+
+void energy_in(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c){
+    auto& data = _storage.Get(p,t,c);
+    spline_type range_spline = get_range_spline(data);
+    for(std::size_t i=0;i<n;i++){
+        res[i] = energy_in(T[i],t.thickness(),range_spline);
+    }
+    }
+
+std::vector<double> energy_in(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c){
+    std::vector<double> ein(T.size());
+    energy_in(p,t,T.data(),ein.data(),T.size(),c);
+    return ein;
+    }
+
 std::vector<double> calculate_tof(Projectile p, const Material &t, const Config &c){
+#ifndef GSL_INTEGRATION
+    // nodes of all energy table intervals are evaluated with the batch kernels
+    auto function = [&](const double *x, double *y, std::size_t n){
+        dispatch_config(c, [&](auto policy){
+            kernels::dedx<decltype(policy)>(p,t,c,x,y,n);
+            });
+        for(std::size_t i=0;i<n;i++)y[i] = 1.0/(y[i]*beta_from_T(x[i]));
+        };
+    std::vector<double> a(max_datapoints), b(max_datapoints);
+    std::vector<double> values(max_datapoints);
+    a[0] = Ezero;
+    b[0] = energy_table(0);
+    for(int i=1;i<max_datapoints;i++){
+        a[i] = energy_table(i-1);
+        b[i] = energy_table(i);
+    }
+    integrator.integrate_batch(function, a.data(), b.data(), values.data(), max_datapoints);
+    values[0] = values[0]*10.0*p.A/(c_light*t.density());
+    for(int i=1;i<max_datapoints;i++){
+        values[i] = values[i]*10.0*p.A/(c_light*t.density()) + values[i-1];
+    }
+    return values;
+#else
     double res;
     std::vector<double> values;
     values.reserve(max_datapoints);
@@ -264,13 +354,21 @@ std::vector<double> calculate_tof(Projectile p, const Material &t, const Config
         values.push_back(res);
     }
     return values;
+#endif
 }
 
 Result calculate(Projectile p, const Material &t, const Config &c){
+    if(p.T<catima::Ezero && p.T<catima::Ezero-catima::numeric_epsilon){return Result();}
+    auto& data = _storage.Get(p,t,c);
+    return calculate(data, p.T, t);
+}
+
+Result calculate(const DataPoint &data, double T, const Material &t){
     Result res;
-    double T = p.T;
     if(T<catima::Ezero && T<catima::Ezero-catima::numeric_epsilon){return res;}
-    auto& data = _storage.Get(p,t,c);
+    Projectile p = data.p;
+    p.T = T;
+    const Config &c = data.config;
 
     bool use_angular_spline = false;
     if(c.scattering == scattering_types::atima_scattering){
@@ -330,7 +428,7 @@ Result calculate(Projectile p, const Material &t, const Config &c){
         }        
         #endif
         if( (!use_angular_spline) && res.range>t.thickness()){ // do not calculate angle scattering when stopped inside material        
-            res.sigma_a = angular_straggling(p(T),t,c);
+            res.sigma_a = sqrt(angular_variance(data,T,t));
         }
         //Interpolator tof_spline(energy_table.values, tofdata.data(), energy_table.num,interpolation_t::linear);
         //res.tof = tof_spline(res.Ein) - tof_spline(res.Eout);
@@ -340,56 +438,86 @@ Result calculate(Projectile p, const Material &t, const Config &c){
     
     // position straggling in material    
     double rrange = std::min(res.range/t.density(), t.thickness_cm());   
-    res.sigma_x = angular_variance(p(T),t,c,2);
+    res.sigma_x = angular_variance(data,T,t,2);
     res.sigma_x = sqrt(res.sigma_x);
 
     rrange = std::min(res.range/t.density(), t.thickness_cm());
     // position vs angle covariance, needed later for final position straggling    
-    res.cov = angular_variance(p(T),t,c,1);
+    res.cov = angular_variance(data,T,t,1);
 
     #ifdef REACTIONS
-    res.sp = nonreaction_rate(p,t,c);
+    res.sp = nonreaction_rate(p,t,data);
     #endif
     return res;
 }
 
+namespace{
+    // accumulates layer results, layer_result(i, e) returns Result of i-th layer for energy e
+    template<typename F>
+    void calculate_layers(double T, const Phasespace &ps, const Layers &layers, MultiResult &res, F&& layer_result){
+        double e = T;
+        res.results.clear();
+        res.total_result = Result();
+        res.total_result.Ein = e;
+        res.total_result.sigma_a = ps.sigma_a*ps.sigma_a;
+        res.total_result.sigma_x = ps.sigma_x*ps.sigma_x;
+        res.total_result.cov = ps.cov_x;
+        res.results.reserve(layers.num());
+        for(int i=0;i<layers.num();i++){
+            const Material &m = layers.get_materials()[i];
+            Result r = layer_result(i, e);
+            e = r.Eout;
+            res.total_result.Eloss += r.Eloss;
+            res.total_result.sigma_E += r.sigma_E*r.sigma_E;
+            res.total_result.tof += r.tof;
+            res.total_result.Eout = r.Eout;
+            double a2 = res.total_result.sigma_a;
+            res.total_result.sigma_x += (2*m.thickness_cm()*res.total_result.cov)
+                                     + (a2*m.thickness_cm()*m.thickness_cm())
+                                     + r.sigma_x*r.sigma_x;
+            res.total_result.cov += a2*m.thickness_cm() + r.cov;
+            res.total_result.sigma_a += r.sigma_a*r.sigma_a;
+            #ifdef REACTIONS
+            res.total_result.sp = (r.sp>=0.0)?res.total_result.sp*r.sp:-1;
+            #endif
+            res.results.push_back(r);
+        }
+        if(e>Ezero){
+            res.total_result.sigma_a = sqrt(res.total_result.sigma_a);
+            res.total_result.sigma_E = sqrt(res.total_result.sigma_E);
+            res.total_result.sigma_x = sqrt(std::abs(res.total_result.sigma_x));
+
+        }
+        else{
+            res.total_result.sigma_a = 0.0;
+            res.total_result.sigma_E = 0.0;
+            res.total_result.sigma_x = sqrt(std::abs(res.total_result.sigma_x));
+            }
+    }
+}
+
+void calculate(const Projectile &p, const Phasespace &ps, const Layers &layers, MultiResult &res, const Config &c){
+    calculate_layers(p.T, ps, layers, res, [&](int i, double e){
+        return calculate(p, layers.get_materials()[i], e, c);
+        });
+}
+
 MultiResult calculate(const Projectile &p, const Phasespace &ps, const Layers &layers, const Config &c){
     MultiResult res;
-    double e = p.T;
-    res.total_result.Ein = e;
-    res.total_result.sigma_a = ps.sigma_a*ps.sigma_a;
-    res.total_result.sigma_x = ps.sigma_x*ps.sigma_x;
-    res.total_result.cov = ps.cov_x;
-    res.results.reserve(layers.num());
-    for(auto&m:layers.get_materials()){
-        Result r = calculate(p,m,e,c);
-        e = r.Eout;        
-        res.total_result.Eloss += r.Eloss;
-        res.total_result.sigma_E += r.sigma_E*r.sigma_E; 
-        res.total_result.tof += r.tof;
-        res.total_result.Eout = r.Eout;        
-        double a2 = res.total_result.sigma_a;
-        res.total_result.sigma_x += (2*m.thickness_cm()*res.total_result.cov) 
-                                 + (a2*m.thickness_cm()*m.thickness_cm()) 
-                                 + r.sigma_x*r.sigma_x;
-        res.total_result.cov += a2*m.thickness_cm() + r.cov;
-        res.total_result.sigma_a += r.sigma_a*r.sigma_a;
-        #ifdef REACTIONS
-        res.total_result.sp = (r.sp>=0.0)?res.total_result.sp*r.sp:-1;
-        #endif
-        res.results.push_back(r);
-    }
-    if(e>Ezero){
-        res.total_result.sigma_a = sqrt(res.total_result.sigma_a);
-        res.total_result.sigma_E = sqrt(res.total_result.sigma_E);
-        res.total_result.sigma_x = sqrt(std::abs(res.total_result.sigma_x));
-        
-    }
-    else{
-        res.total_result.sigma_a = 0.0;
-        res.total_result.sigma_E = 0.0;
-        res.total_result.sigma_x = sqrt(std::abs(res.total_result.sigma_x));
-        }
+    calculate(p, ps, layers, res, c);
+    return res;
+}
+
+void calculate(const std::vector<std::shared_ptr<const DataPoint>> &data, double T, const Phasespace &ps, const Layers &layers, MultiResult &res){
+    assert(data.size() == static_cast<std::size_t>(layers.num()));
+    calculate_layers(T, ps, layers, res, [&](int i, double e){
+        return calculate(*data[i], e, layers.get_materials()[i]);
+        });
+}
+
+MultiResult calculate(const std::vector<std::shared_ptr<const DataPoint>> &data, double T, const Phasespace &ps, const Layers &layers){
+    MultiResult res;
+    calculate(data, T, ps, layers, res);
     return res;
 }
 
@@ -399,11 +527,318 @@ Result calculate(double pa, int pz, double T, double ta, double tz, double thick
     return calculate(p(T),m);
 }
 
+#ifndef GSL_INTEGRATION
+namespace{
+    // integrands of range, angular variance and range straggling
+    struct DataPointIntegrands{
+        std::vector<double> range;
+        std::vector<double> angular;
+        std::vector<double> straggling;
+    };
+
+    // evaluates the integrands at the energies T with the batch kernels
+    DataPointIntegrands datapoint_integrands(Projectile p, const Material &t, const Config &c, const std::vector<double> &T){
+        const std::size_t n = T.size();
+        DataPointIntegrands f;
+        f.range.resize(n);
+        f.angular.resize(n);
+        f.straggling.resize(n);
+        dispatch_config(c, [&](auto policy){
+            using P = decltype(policy);
+            kernels::dedx<P>(p,t,c,T.data(),f.range.data(),n);
+            kernels::domega2dx<P>(p,t,c,T.data(),f.straggling.data(),n);
+            });
+        for(std::size_t j=0;j<n;j++){
+            const double s = f.range[j];
+            f.range[j] = 1.0/s;
+            f.angular[j] = da2dx(p(T[j]),t,c)/s;
+            f.straggling[j] = f.straggling[j]/(s*s*s);
+        }
+        return f;
+    }
+
+    // Gauss-Legendre nodes in (a,b) in ascending order and corresponding weights for unit half-width
+    template<typename I>
+    void gl_nodes(const I &gl, double a, double b, double *x, double *w){
+        auto points = gl.get_points(a,b);
+        const int num = gl.n()/2;
+        for(int k=0;k<num;k++){
+            w[num-k-1] = gl.w(k);
+            w[num+k] = gl.w(k);
+        }
+        std::copy(points.begin(), points.end(), x);
+    }
+
+#ifdef ELEMENT_TABLES
+    // Gauss-Legendre nodes of all energy table intervals, nodes of i-th interval start at integrator.n()*(i-1)
+    const std::vector<double>& reference_nodes(){
+        static const std::vector<double> nodes = [](){
+            const int order = integrator.n();
+            std::vector<double> x(order*(max_datapoints-1));
+            std::vector<double> w(order);
+            for(int i=1;i<max_datapoints;i++){
+                gl_nodes(integrator, energy_table(i-1), energy_table(i), x.data()+order*(i-1), w.data());
+            }
+            return x;
+        }();
+        return nodes;
+    }
+
+    // stopping, straggling and angular scattering power of the single element at the reference nodes
+    struct ElementTable{
+        std::once_flag flag;
+        std::vector<double> dedx;
+        std::vector<double> domega2dx;
+        std::vector<double> da2dx;
+    };
+
+    struct ElementKey{
+        double pa, pz, pq;
+        double ta;
+        int tz;
+        std::array<unsigned char, sizeof(Config)> config;
+        bool operator<(const ElementKey &o) const {
+            return std::tie(pa,pz,pq,ta,tz,config) < std::tie(o.pa,o.pz,o.pq,o.ta,o.tz,o.config);
+        }
+    };
+
+    // returns the table of projectile-element-config combination, the table is calculated on the first use
+    std::shared_ptr<ElementTable> element_table(Projectile p, const Target &t, const Config &c){
+        static std::mutex mutex;
+        static std::map<ElementKey, std::shared_ptr<ElementTable>> tables;
+        ElementKey key{p.A, p.Z, p.Q, t.A, t.Z, {}};
+        std::memcpy(key.config.data(), &c, sizeof(Config));
+        std::shared_ptr<ElementTable> e;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = tables.find(key);
+            if(it==tables.end()){
+                if(tables.size()>=max_element_tables)tables.clear(); // tables in use are kept by their owners
+                it = tables.emplace(key, std::make_shared<ElementTable>()).first;
+            }
+            e = it->second;
+        }
+        std::call_once(e->flag, [&](){
+            const std::vector<double> &T = reference_nodes();
+            const std::size_t n = T.size();
+            Material m;
+            m.add_element(t.A, t.Z, 1.0);
+            e->dedx.resize(n);
+            e->domega2dx.resize(n);
+            e->da2dx.resize(n);
+            dispatch_config(c, [&](auto policy){
+                using P = decltype(policy);
+                kernels::dedx<P>(p,m,c,T.data(),e->dedx.data(),n);
+                kernels::domega2dx<P>(p,m,c,T.data(),e->domega2dx.data(),n);
+                });
+            for(std::size_t j=0;j<n;j++)e->da2dx[j] = da2dx(p(T[j]),m,c);
+            });
+        return e;
+    }
+
+    /**
+      * integrands at the reference nodes synthesised from the element tables,
+      * dedx, domega2dx and da2dx of the compound are weight fraction sums over the elements (Bragg additivity),
+      * so it is valid only for Material with elemental ionisation potentials
+      */
+    DataPointIntegrands element_integrands(const Projectile &p, const Material &t, const Config &c){
+        const std::size_t n = reference_nodes().size();
+        DataPointIntegrands f;
+        f.range.assign(n, 0.0);
+        f.angular.assign(n, 0.0);
+        f.straggling.assign(n, 0.0);
+        for(int i=0;i<t.ncomponents();i++){
+            const double w = t.weight_fraction(i);
+            auto e = element_table(p, t.get_element(i), c);
+            for(std::size_t j=0;j<n;j++){
+                f.range[j] += w*e->dedx[j];
+                f.straggling[j] += w*e->domega2dx[j];
+                f.angular[j] += w*e->da2dx[j];
+            }
+        }
+        for(std::size_t j=0;j<n;j++){
+            const double s = f.range[j];
+            f.range[j] = 1.0/s;
+            f.angular[j] = f.angular[j]/s;
+            f.straggling[j] = f.straggling[j]/(s*s*s);
+        }
+        return f;
+    }
+#endif
+
+    /**
+      * interpolatory weights of the 3N nodes of three neighbouring intervals of the logarithmic energy table
+      * the intervals are (0,1), (1,1+r) and (1+r,1+r+r^2), the Gauss-Legendre nodes of order N are used in all of them
+      * weights[k] integrate over the k-th interval
+      */
+    template<int N>
+    std::array<std::array<double,3*N>,3> triple_weights(double r){
+        const double edges[4] = {0.0, 1.0, 1.0+r, 1.0+r+r*r};
+        double u[3*N], w[N];
+        for(int k=0;k<3;k++)gl_nodes(GaussLegendreIntegration<N>(), edges[k], edges[k+1], u+N*k, w);
+        const double shift = 0.5*edges[3];
+        for(double &v:u)v -= shift;
+        std::array<std::array<double,3*N>,3> res;
+        for(int part=0;part<3;part++){
+            const double lo = edges[part]-shift;
+            const double hi = edges[part+1]-shift;
+            // solve sum_j w_j u_j^k = integral of u^k with Gaussian elimination
+            double A[3*N][3*N+1];
+            for(int k=0;k<3*N;k++){
+                for(int j=0;j<3*N;j++)A[k][j] = std::pow(u[j],k);
+                A[k][3*N] = (std::pow(hi,k+1)-std::pow(lo,k+1))/(k+1);
+            }
+            for(int col=0;col<3*N;col++){
+                int piv = col;
+                for(int k=col+1;k<3*N;k++)if(std::abs(A[k][col])>std::abs(A[piv][col]))piv = k;
+                if(piv!=col)for(int j=0;j<=3*N;j++)std::swap(A[col][j],A[piv][j]);
+                for(int k=col+1;k<3*N;k++){
+                    const double m = A[k][col]/A[col][col];
+                    for(int j=col;j<=3*N;j++)A[k][j] -= m*A[col][j];
+                }
+            }
+            for(int k=3*N-1;k>=0;k--){
+                double v = A[k][3*N];
+                for(int j=k+1;j<3*N;j++)v -= A[k][j]*res[part][j];
+                res[part][k] = v/A[k][k];
+            }
+        }
+        return res;
+    }
+
+    /**
+      * integrates the DataPoint tables with N point quadrature, the error of every interval is estimated
+      * from the difference to the higher degree interpolatory rule of the nodes of the interval and its neighbours,
+      * intervals with estimated relative error above tolerance and their neighbours are integrated with the reference integrator
+      */
+    template<int N>
+    void integrate_DataPoint_tiered(DataPoint &dp, Projectile p, const Material &t, const Config &c, double tolerance){
+        const GaussLegendreIntegration<N> gl;
+        const int nint = max_datapoints-1;
+        const double r = (energy_table(2)-energy_table(1))/(energy_table(1)-energy_table(0));
+        static const auto tw = triple_weights<N>(r);
+
+        std::vector<double> nodes(N*nint);
+        double w[N];
+        for(int i=0;i<nint;i++){
+            gl_nodes(gl, energy_table(i), energy_table(i+1), nodes.data()+N*i, w);
+        }
+        auto f = datapoint_integrands(p,t,c,nodes);
+
+        std::vector<double> range(nint), angular(nint), straggling(nint);
+        for(int i=0;i<nint;i++){
+            double vr = 0.0, va = 0.0, vo = 0.0;
+            for(int k=0;k<N;k++){
+                vr += w[k]*f.range[N*i+k];
+                va += w[k]*f.angular[N*i+k];
+                vo += w[k]*f.straggling[N*i+k];
+            }
+            const double half = 0.5*(energy_table(i+1)-energy_table(i));
+            range[i] = half*vr;
+            angular[i] = half*va;
+            straggling[i] = half*vo;
+        }
+
+        // error estimate
+        std::vector<char> flag(nint, 0);
+        for(int i=0;i<nint;i++){
+            const int first = std::min(std::max(i-1,0), nint-3);
+            const int part = i-first;
+            const double h = energy_table(first+1)-energy_table(first);
+            for(auto g:{std::make_pair(&f.range, &range), std::make_pair(&f.angular, &angular), std::make_pair(&f.straggling, &straggling)}){
+                double v = 0.0;
+                for(int k=0;k<3*N;k++)v += tw[part][k]*(*g.first)[N*first+k];
+                v *= h;
+                const double q = (*g.second)[i];
+                if(std::abs(v-q) > tolerance*std::abs(q))flag[i] = 1;
+            }
+        }
+        std::vector<int> refine;
+        for(int i=0;i<nint;i++){
+            if(flag[i] || (i>0 && flag[i-1]==1) || (i<nint-1 && flag[i+1]==1))refine.push_back(i);
+        }
+
+        // reference integration of refined intervals
+        if(!refine.empty()){
+            const int order = integrator.n();
+            std::vector<double> rnodes(order*refine.size());
+            std::vector<double> rw(order);
+            for(std::size_t j=0;j<refine.size();j++){
+                gl_nodes(integrator, energy_table(refine[j]), energy_table(refine[j]+1), rnodes.data()+order*j, rw.data());
+            }
+            auto fr = datapoint_integrands(p,t,c,rnodes);
+            for(std::size_t j=0;j<refine.size();j++){
+                const int i = refine[j];
+                double vr = 0.0, va = 0.0, vo = 0.0;
+                for(int k=0;k<order;k++){
+                    vr += rw[k]*fr.range[order*j+k];
+                    va += rw[k]*fr.angular[order*j+k];
+                    vo += rw[k]*fr.straggling[order*j+k];
+                }
+                const double half = 0.5*(energy_table(i+1)-energy_table(i));
+                range[i] = half*vr;
+                angular[i] = half*va;
+                straggling[i] = half*vo;
+            }
+        }
+
+        for(int i=1;i<max_datapoints;i++){
+            dp.range[i] = p.A*range[i-1] + dp.range[i-1];
+            dp.angular_variance[i] = p.A*angular[i-1] + dp.angular_variance[i-1];
+            dp.range_straggling[i] = p.A*straggling[i-1] + dp.range_straggling[i-1];
+        }
+    }
+}
+#endif
+
 DataPoint calculate_DataPoint(Projectile p, const Material &t, const Config &c){
     DataPoint dp(p,t,c);
     dp.range.resize(max_datapoints);
     dp.range_straggling.resize(max_datapoints);
     dp.angular_variance.resize(max_datapoints);
+    dp.range[0] = 0.0;
+    dp.angular_variance[0] = 0.0;
+    dp.range_straggling[0]=0.0;
+#ifndef GSL_INTEGRATION
+    if(c.accuracy == accuracy_types::standard){
+        integrate_DataPoint_tiered<4>(dp,p,t,c,accuracy_standard_tolerance);
+    }
+    else if(c.accuracy == accuracy_types::fast){
+        integrate_DataPoint_tiered<2>(dp,p,t,c,accuracy_fast_tolerance);
+    }
+    else{
+        // all Gauss-Legendre nodes of the energy table intervals are evaluated with the batch kernels
+        const int order = integrator.n();
+        std::vector<double> w(order);
+#ifdef ELEMENT_TABLES
+        std::vector<double> x(order);
+        gl_nodes(integrator, energy_table(0), energy_table(1), x.data(), w.data());
+        // compounds with elemental ionisation potentials are summed from the cached element tables
+        auto f = (t.I()==0.0)?element_integrands(p,t,c):datapoint_integrands(p,t,c,reference_nodes());
+#else
+        const std::size_t nnodes = order*(max_datapoints-1);
+        std::vector<double> nodes(nnodes);
+        for(int i=1;i<max_datapoints;i++){
+            gl_nodes(integrator, energy_table(i-1), energy_table(i), nodes.data()+order*(i-1), w.data());
+        }
+        auto f = datapoint_integrands(p,t,c,nodes);
+#endif
+
+        for(int i=1;i<max_datapoints;i++){
+            const double half = 0.5*(energy_table(i)-energy_table(i-1));
+            double r = 0.0, a = 0.0, o = 0.0;
+            for(int k=0;k<order;k++){
+                const std::size_t j = order*(i-1) + k;
+                r += w[k]*f.range[j];
+                a += w[k]*f.angular[j];
+                o += w[k]*f.straggling[j];
+            }
+            dp.range[i] = p.A*half*r + dp.range[i-1];
+            dp.angular_variance[i] = p.A*half*a + dp.angular_variance[i-1];
+            dp.range_straggling[i] = p.A*half*o + dp.range_straggling[i-1];
+        }
+    }
+#else
     auto fdedx = [&](double x)->double{
             return 1.0/dedx(p(x),t,c);
             };
@@ -413,25 +848,9 @@ DataPoint calculate_DataPoint(Projectile p, const Material &t, const Config &c){
     auto ftheta = [&](double x)->double{
           return da2de(p(x),t,c);
           };
-
-    //double res=0.0;
-    //calculate 1st point to have i-1 element ready for loop
-    //res = integrator.integrate(fdedx,Ezero,energy_table(0));
-    //res = p.A*res;
-    //dp.range[0] = res;
-    
-    dp.range[0] = 0.0;
-    dp.angular_variance[0] = 0.0;
-
-    //res = integrator.integrate(fomega,Ezero,energy_table(0));
-    //res = p.A*res;
-    dp.range_straggling[0]=0.0;
-    //p.T = energy_table(0);    
     for(int i=1;i<max_datapoints;i++){
         double res = p.A*integrator.integrate(fdedx,energy_table(i-1),energy_table(i));
         dp.range[i] = res + dp.range[i-1];
-        //res = da2dx(p(energy_table(i)),t)*res;
-        //dp.angular_variance[i] = res + dp.angular_variance[i-1];        
         dp.angular_variance[i] = p.A*integrator.integrate(ftheta,energy_table(i-1),energy_table(i))
                                 + dp.angular_variance[i-1];
 
@@ -439,13 +858,30 @@ DataPoint calculate_DataPoint(Projectile p, const Material &t, const Config &c){
         res = p.A*res;
         dp.range_straggling[i] = res + dp.range_straggling[i-1];
     }
+#endif
+#ifdef STORE_SPLINES
+    // vectors are moved together with DataPoint, so the splines stay valid
+    dp.range_spline = Interpolator(energy_table, dp.range);
+    dp.range_straggling_spline = Interpolator(energy_table, dp.range_straggling);
+    dp.angular_variance_spline = Interpolator(energy_table, dp.angular_variance);
+#endif
     return dp;
 }
 
 double calculate_tof_from_E(Projectile p, double Eout, const Material &t, const Config &c){
     double res;
+#ifndef GSL_INTEGRATION
+    auto function = [&](const double *x, double *y, std::size_t n){
+        dispatch_config(c, [&](auto policy){
+            kernels::dedx<decltype(policy)>(p,t,c,x,y,n);
+            });
+        for(std::size_t i=0;i<n;i++)y[i] = 1.0/(y[i]*beta_from_T(x[i]));
+        };
+    res = integrator.integrate_batch(function,Eout,p.T);
+#else
     auto function = [&](double x)->double{return 1.0/(dedx(p(x),t,c)*beta_from_T(x));};
     res = integrator.integrate(function,Eout,p.T);
+#endif
     res = res*10.0*p.A/(c_light*t.density());
     return res;
 }
@@ -455,8 +891,9 @@ std::pair<double,double> w_magnification(const Projectile &p, double Ein, const
     if(t.density()<= 0.0 || t.thickness()<=0){
         return res;
     }
-    std::vector<double> energies{0.99*Ein, Ein, 1.01*Ein};
-    auto eres = energy_out(p,energies,t,c);
+    const double energies[3] = {0.99*Ein, Ein, 1.01*Ein};
+    double eres[3];
+    energy_out(p,t,energies,eres,3,c);
     if(eres[0]>0.0 && eres[1]>0.0 && eres[2]>0.0){
         res.first = energies[1]*(eres[2]-eres[0])/(eres[1]*(energies[2]-energies[0]));
         res.second = p_from_T(energies[1],p.A)*(p_from_T(eres[2],p.A)-p_from_T(eres[0],p.A))/( p_from_T(eres[1],p.A)*( p_from_T(energies[2],p.A)-p_from_T(energies[0],p.A) ) );
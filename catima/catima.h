@@ -19,6 +19,7 @@
 
 #include <utility>
 #include <vector>
+#include <memory>
 
 // #define NDEBUG
 #include "catima/build_config.h"
@@ -47,6 +48,33 @@ namespace catima{
       */
     double domega2dx(const Projectile &p, const Material &t, const Config &c=default_config);
 
+    /**
+      * calculate dEdx for multiple energies, batch stopping kernels are used
+      * @param p - Projectile
+      * @param T - vector of energies in MeV/u
+      * @param mat - Material
+      * @return vector of dEdx
+      */
+    std::vector<double> dedx(const Projectile &p, const std::vector<double> &T, const Material &mat, const Config &c=default_config);
+
+    /**
+      * calculate dEdx for n energies T, results are stored to res
+      * the caller provides the output array of size n, nothing is allocated
+      */
+    void dedx(const Projectile &p, const Material &mat, const double *T, double *res, std::size_t n, const Config &c=default_config);
+
+    /**
+      * calculate energy loss straggling variance for multiple energies
+      * @param T - vector of energies in MeV/u
+      * @return vector of dOmega^2/dx
+      */
+    std::vector<double> domega2dx(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c=default_config);
+
+    /**
+      * calculate energy loss straggling variance for n energies T, results are stored to res
+      */
+    void domega2dx(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c=default_config);
+
     /**
       * calculates variance of angular scattering of Projectile p on Material m
       */
@@ -77,6 +105,11 @@ namespace catima{
       */
     std::vector<double> dedx_from_range(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c=default_config);
 
+    /**
+      * returns the dEdx calculated from range spline for n energies T, results are stored to res
+      */
+    void dedx_from_range(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c=default_config);
+
     /**
       * returns the  range straggling of the Projectile in Material from spline
       * @param p - Projectile
@@ -130,6 +163,16 @@ namespace catima{
       */
     double angular_variance(Projectile p, const Material &t, const Config &c=default_config, int order = 0);
 
+    /**
+      * returns the planar RMS angular variance in rad using precalculated DataPoint
+      * this version does not access the global storage
+      * @param data - DataPoint of the Projectile-Material-Config combination
+      * @param T - energy in MeV/u
+      * @param t - Material class
+      * @return angular RMS variance in rad
+      */
+    double angular_variance(const DataPoint &data, double T, const Material &t, int order = 0);
+
     /**
       * calculates angular scattering in the material from difference of incoming a nd outgoing energies
       * @param p - Projectile
@@ -138,7 +181,7 @@ namespace catima{
       * @param mat - Material
       * @return angular straggling
       */
-    double angular_straggling_from_E(const Projectile &p, double Tout,Material t, const Config &c=default_config);
+    double angular_straggling_from_E(const Projectile &p, double Tout,const Material &t, const Config &c=default_config);
 
     /**
       * calculates Energy straggling in the material from difference of incoming a nd outgoing energies
@@ -177,6 +220,42 @@ namespace catima{
       */
     std::vector<double> energy_out(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c=default_config);
 
+    /**
+      * calculates outcoming energies for n incoming energies T, results are stored to res
+      */
+    void energy_out(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c=default_config);
+
+    /**
+      * calculates incoming energy from range spline, inverse of energy_out
+      * @param T - outcoming energy
+      * @thickness - thicnkess of the target in g/cm2
+      * @range_spline - precaclulated range spline for material
+      * @return incoming energy in Mev/u, -1 if out of tabulated range
+      */
+    double energy_in(double T, double thickness, const Interpolator &range_spline);
+
+    /**
+      * calculates incoming energy from the outcoming energy
+      * @p - Projectile, p.T is outcoming energy
+      * @t - Material
+      * @return incoming energy before the material in Mev/u
+      */
+    double energy_in(const Projectile &p, const Material &t, const Config &c=default_config);
+
+    /**
+      * calculates incoming energies from the outcoming energies
+      * @p - Projectile
+      * @t - Material
+      * @param T - outcoming energy vector
+      * @return incoming energy before the material in Mev/u
+      */
+    std::vector<double> energy_in(const Projectile &p, const std::vector<double> &T, const Material &t, const Config &c=default_config);
+
+    /**
+      * calculates incoming energies for n outcoming energies T, results are stored to res
+      */
+    void energy_in(const Projectile &p, const Material &t, const double *T, double *res, std::size_t n, const Config &c=default_config);
+
     /**
       * calculates all observables for projectile passing material
       * @param p - Projectile
@@ -189,6 +268,17 @@ namespace catima{
         return calculate(p, t, c);
     }
 
+    /**
+      * calculates all observables for projectile passing material using precalculated DataPoint
+      * the projectile and config are taken from the DataPoint, thickness from the Material,
+      * the global storage is not accessed so this can be called from multiple threads
+      * @param data - DataPoint of the Projectile-Material-Config combination
+      * @param T - energy in MeV/u
+      * @param t - Material
+      * @return structure of Result
+      */
+    Result calculate(const DataPoint &data, double T, const Material &t);
+
       /**
       * wrapper to other calculate function with simplified arguments
       * @param p - Projectile
@@ -205,6 +295,13 @@ namespace catima{
       */
     MultiResult calculate(const Projectile &p, const Phasespace &ps, const Layers &layers, const Config &c=default_config);
 
+    /**
+      * calculate observables for multiple layers of material, results are stored to res
+      * the storage of res.results is reused, so repeated calls with the same MultiResult do not allocate
+      * @param res - MultiResult to store results
+      */
+    void calculate(const Projectile &p, const Phasespace &ps, const Layers &layers, MultiResult &res, const Config &c=default_config);
+
     /**
       * calculate observables for multiple layers of material defined by Layers
       * @return results stored in MultiResult structure
@@ -217,6 +314,18 @@ namespace catima{
         return calculate(p(T), layers, c);
     }
 
+    /**
+      * calculate observables for multiple layers of material using precalculated DataPoints
+      * the global storage is not accessed so this can be called from multiple threads
+      * @param data - DataPoints, i-th DataPoint belongs to i-th layer
+      * @param T - energy in MeV/u
+      * @param ps - initial Phasespace
+      * @param layers - Layers
+      * @return results stored in MultiResult structure
+      */
+    MultiResult calculate(const std::vector<std::shared_ptr<const DataPoint>> &data, double T, const Phasespace &ps, const Layers &layers);
+    void calculate(const std::vector<std::shared_ptr<const DataPoint>> &data, double T, const Phasespace &ps, const Layers &layers, MultiResult &res);
+
  
     /// this calculate tof spline, at the moment it is not used
     std::vector<double> calculate_tof(const Projectile p, const Material &t, const Config &c=default_config);
@@ -55,6 +55,18 @@ namespace catima{
         atima_scattering = 255,
     };
 
+    /**
+      * enum to select accuracy of the integration of the tables
+      * reference - 8 point Gauss-Legendre quadrature on every interval
+      * standard, fast - lower order quadrature, intervals where the estimated
+      * relative error is above the tier tolerance are calculated as reference
+      */
+    enum accuracy_types:unsigned char{
+        reference = 0,
+        standard = 1,
+        fast = 2,
+    };
+
     /**
       * structure to store calculation configuration
       */
@@ -69,6 +81,7 @@ namespace catima{
         unsigned char calculation = 1;
         unsigned char low_energy = low_energy_types::srim_85;
         unsigned char scattering = scattering_types::atima_scattering;        
+        unsigned char accuracy = accuracy_types::reference;
     };
 
 
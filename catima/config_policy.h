@@ -0,0 +1,74 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/// \file config_policy.h
+#ifndef CATIMA_CONFIG_POLICY_H
+#define CATIMA_CONFIG_POLICY_H
+#include "catima/config.h"
+
+namespace catima{
+
+    /**
+      * policy reading the configuration values from Config at runtime
+      */
+    struct RuntimePolicy{
+        static unsigned char z_effective(const Config &c){return c.z_effective;}
+        static unsigned char corrections(const Config &c){return c.corrections;}
+        static unsigned char calculation(const Config &c){return c.calculation;}
+    };
+
+    /**
+      * policy with configuration values fixed at compile time
+      * the kernels instantiated with it have the Config branches folded away
+      */
+    template<unsigned char ZEFF, unsigned char CORRECTIONS, unsigned char CALCULATION>
+    struct ConfigPolicy{
+        static constexpr unsigned char z_effective(const Config &){return ZEFF;}
+        static constexpr unsigned char corrections(const Config &){return CORRECTIONS;}
+        static constexpr unsigned char calculation(const Config &){return CALCULATION;}
+    };
+
+    namespace detail{
+        template<unsigned char ZEFF, typename F>
+        decltype(auto) dispatch_calculation(const Config &c, F&& f){
+            if(c.calculation == omega_types::atima)return f(ConfigPolicy<ZEFF, 0, omega_types::atima>());
+            return f(ConfigPolicy<ZEFF, 0, omega_types::bohr>());
+        }
+    }
+
+    /**
+      * calls f(policy) with the policy matching the Config
+      * the compile time policies are used for all effective charge and straggling options
+      * with all dEdx corrections enabled, other Configs use RuntimePolicy
+      * @param c - Config
+      * @param f - callable accepting the policy object
+      */
+    template<typename F>
+    decltype(auto) dispatch_config(const Config &c, F&& f){
+        if(c.corrections != 0 || c.calculation > omega_types::bohr)return f(RuntimePolicy());
+        switch(c.z_effective){
+            case z_eff_type::none:            return detail::dispatch_calculation<z_eff_type::none>(c, f);
+            case z_eff_type::pierce_blann:    return detail::dispatch_calculation<z_eff_type::pierce_blann>(c, f);
+            case z_eff_type::anthony_landorf: return detail::dispatch_calculation<z_eff_type::anthony_landorf>(c, f);
+            case z_eff_type::hubert:          return detail::dispatch_calculation<z_eff_type::hubert>(c, f);
+            case z_eff_type::winger:          return detail::dispatch_calculation<z_eff_type::winger>(c, f);
+            case z_eff_type::schiwietz:       return detail::dispatch_calculation<z_eff_type::schiwietz>(c, f);
+            case z_eff_type::global:          return detail::dispatch_calculation<z_eff_type::global>(c, f);
+            case z_eff_type::atima14:         return detail::dispatch_calculation<z_eff_type::atima14>(c, f);
+            default:                          return f(RuntimePolicy());
+        }
+    }
+}
+
+#endif
@@ -1,5 +1,6 @@
 #ifndef CONSTANTS_H
 #define CONSTANTS_H
+#include <cstddef>
 #include <limits>
 #include "catima/build_config.h"
 namespace catima {
@@ -10,11 +11,32 @@ constexpr double logEmin = -3; // log of minimum energy
 constexpr double logEmax = 7.0;  // log of max energy
 constexpr int max_datapoints = 600; // how many datapoints between logEmin and logEmax
 constexpr int max_storage_data = 60; // number of datapoints which can be stored in cache
+constexpr int material_inline_elements = 8; // number of Material elements stored without heap allocation
+constexpr unsigned int max_element_tables = 256; // number of cached projectile-element tables, see ELEMENT_TABLES
+constexpr int max_shared_storage_data = 500; // number of datapoints stored in the cache shared between threads
 constexpr double numeric_epsilon = 10*std::numeric_limits<double>::epsilon();
 constexpr double Eout_th_epsilon = 1e-5;  //
 
 constexpr double thin_target_limit = 1 - 1e-3;
 
+constexpr int layers_table_points = 400; // number of energy points of LayersTable
+constexpr double layers_table_margin = 1e-3; // relative distance above stopping threshold where LayersTable starts
+
+constexpr double srim_table_logemin = -3.0; // log10 of minimum energy of SRIM low energy tables
+constexpr double srim_table_logemax = 1.5;  // log10 of maximum energy of SRIM low energy tables
+constexpr int srim_table_points = 451; // number of points of SRIM low energy tables
+constexpr int zeff_table_points = 1001; // number of points of effective charge tables between logEmin and logEmax
+constexpr double zeff_table_tolerance = 1e-5; // relative interpolation error of effective charge tables
+constexpr double accuracy_standard_tolerance = 1e-7; // relative error of the table intervals for accuracy_types::standard
+constexpr double accuracy_fast_tolerance = 1e-4; // relative error of the table intervals for accuracy_types::fast
+constexpr int ls_min_partial_waves = 10; // minimum number of partial waves summed for Lindhard-Sorensen correction
+constexpr int ls_stable_partial_waves = 3; // number of consecutive partial waves within tolerance to stop the LS sum
+constexpr double ls_table_tolerance = 1e-4; // tolerance of the partial wave sums of the per projectile LS tables
+constexpr double ls_mass_window_low = -0.25; // lowest relative deviation from atomic weight interpolated from generated LS coefficients
+constexpr double ls_mass_window_high = 0.35; // highest relative deviation from atomic weight interpolated from generated LS coefficients
+constexpr double ls_max_exact_z = 137.0; // highest Z of the exact LS corrections, Z*alpha must stay below 1
+constexpr std::size_t ls_max_tables = 64; // number of per projectile LS tables kept in memory
+
 #ifdef REACTIONS
 constexpr double emin_reaction = 30.0;
 constexpr bool reactions = true;
@@ -4,6 +4,38 @@
 #include "catima/nucdata.h"
 #include "catima/reactions.h"
 #include <cstring>
+#include <memory>
+#include <new>
+
+struct CatimaContext{
+    catima::Config config;
+};
+
+struct CatimaMaterial{
+    catima::Material m;
+};
+
+struct CatimaPrepared{
+    std::shared_ptr<const catima::DataPoint> data;
+    catima::Material m;
+};
+
+namespace{
+    CatimaResult to_c_result(const catima::Result &r){
+        CatimaResult res;
+        res.Ein = r.Ein;
+        res.Eout = r.Eout;
+        res.Eloss = r.Eloss;
+        res.range = r.range;
+        res.dEdxi = r.dEdxi;
+        res.dEdxo = r.dEdxo;
+        res.sigma_E = r.sigma_E;
+        res.sigma_a = r.sigma_a;
+        res.sigma_r = r.sigma_r;
+        res.tof = r.tof;
+        return res;
+    }
+}
 
 extern "C" {
     struct CatimaConfig catima_defaults = {1};
@@ -30,19 +62,8 @@ extern "C" {
         catima::Projectile p(pa,pz);
         catima::Material mat = make_material(ta,tz, thickness, density);
         catima::Result r =  catima::calculate(p(T),mat);    
-        CatimaResult res;
-        res.Ein = r.Ein;
-        res.Eout = r.Eout;
-        res.Eloss = r.Eloss;
-        res.range = r.range;
-        res.dEdxi = r.dEdxi;
-        res.dEdxo = r.dEdxo;
-        res.sigma_E = r.sigma_E;
-        res.sigma_a = r.sigma_a;
-        res.sigma_r = r.sigma_r;
-        res.tof = r.tof;
         // printf("%d\n",catima::_storage.get_index());
-        return res;
+        return to_c_result(r);
     }
 
     double catima_Eout(double pa, int pz, double T, double ta, double tz, double thickness, double density){
@@ -93,4 +114,79 @@ extern "C" {
         return catima::nonreaction_rate(p,mat);
     }
 
-}
\ No newline at end of file
+    CatimaContext* catima_context_new(const struct CatimaConfig *config){
+        CatimaContext *ctx = new(std::nothrow) CatimaContext;
+        if(!ctx)return nullptr;
+        ctx->config.z_effective = config?config->z_effective:catima_defaults.z_effective;
+        ctx->config.scattering = 255;
+        return ctx;
+    }
+
+    void catima_context_free(CatimaContext *ctx){delete ctx;}
+
+    CatimaMaterial* catima_material_new(double ta, double tz, double thickness, double density){
+        try{
+            if(tz==0){
+                catima::Material m;
+                m.density(density).thickness(thickness);
+                return new CatimaMaterial{m};
+            }
+            return new CatimaMaterial{make_material(ta,tz,thickness,density)};
+        }
+        catch(...){
+            return nullptr;
+        }
+    }
+
+    int catima_material_add_element(CatimaMaterial *mat, double a, int z, double stn){
+        try{
+            mat->m.add_element(a,z,stn);
+        }
+        catch(...){
+            return 1;
+        }
+        return 0;
+    }
+
+    void catima_material_set_thickness(CatimaMaterial *mat, double thickness){mat->m.thickness(thickness);}
+
+    void catima_material_free(CatimaMaterial *mat){delete mat;}
+
+    CatimaPrepared* catima_prepare(const CatimaContext *ctx, double pa, int pz, const CatimaMaterial *mat){
+        if(!ctx || !mat || mat->m.ncomponents()==0)return nullptr;
+        try{
+            catima::Projectile p(pa,pz);
+            return new CatimaPrepared{catima::_shared_storage.Get(p, mat->m, ctx->config), mat->m};
+        }
+        catch(...){
+            return nullptr;
+        }
+    }
+
+    void catima_prepared_free(CatimaPrepared *prep){delete prep;}
+
+    CatimaResult catima_prepared_calculate(const CatimaPrepared *prep, double T){
+        return to_c_result(catima::calculate(*prep->data, T, prep->m));
+    }
+
+    void catima_prepared_calculate_n(const CatimaPrepared *prep, const double *T, CatimaResult *res, size_t n){
+        for(size_t i=0;i<n;i++){
+            res[i] = to_c_result(catima::calculate(*prep->data, T[i], prep->m));
+        }
+    }
+
+    void catima_prepared_Eout_n(const CatimaPrepared *prep, const double *T, double *res, size_t n){
+        catima::spline_type range_spline = catima::get_range_spline(*prep->data);
+        for(size_t i=0;i<n;i++){
+            res[i] = (T[i]<catima::Ezero)?0.0:catima::energy_out(T[i], prep->m.thickness(), range_spline);
+        }
+    }
+
+    void catima_prepared_range_n(const CatimaPrepared *prep, const double *T, double *res, size_t n){
+        catima::spline_type range_spline = catima::get_range_spline(*prep->data);
+        for(size_t i=0;i<n;i++){
+            res[i] = range_spline(T[i]);
+        }
+    }
+
+}
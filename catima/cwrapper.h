@@ -1,6 +1,8 @@
 #ifndef CATIMA_CWRAPPER
 #define CATIMA_CWRAPPER
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +49,40 @@ double catima_energy_straggling_from_E(double pa, int pz, double Tin, double Tou
 double atomic_weight(int i);
 double catima_nonreaction_rate(double pa, int pz, double T, double ta, double tz, double thickness);
 
+/*
+ * handle based interface
+ * the context holds the configuration, the material holds the target and its thickness,
+ * the prepared handle holds the projectile-material tables, so repeated evaluation
+ * does not rebuild the structures nor search the cache.
+ * The handles do not use catima_defaults nor the global config. Functions taking
+ * const handles can be called from multiple threads and do not allocate memory.
+ * The functions creating handles return NULL on failure.
+ */
+typedef struct CatimaContext CatimaContext;
+typedef struct CatimaMaterial CatimaMaterial;
+typedef struct CatimaPrepared CatimaPrepared;
+
+/* context with the given config, if config is NULL catima_defaults are used */
+CatimaContext* catima_context_new(const struct CatimaConfig *config);
+void catima_context_free(CatimaContext *ctx);
+
+/* material with the same arguments as catima_calculate, tz > 200 selects the predefined compound,
+ * for tz = 0 the material is empty and the elements are added by catima_material_add_element */
+CatimaMaterial* catima_material_new(double ta, double tz, double thickness, double density);
+/* adds element to the material, returns 0 on success */
+int catima_material_add_element(CatimaMaterial *mat, double a, int z, double stn);
+void catima_material_set_thickness(CatimaMaterial *mat, double thickness);
+void catima_material_free(CatimaMaterial *mat);
+
+/* tables for the projectile and material are calculated, the material is copied */
+CatimaPrepared* catima_prepare(const CatimaContext *ctx, double pa, int pz, const CatimaMaterial *mat);
+void catima_prepared_free(CatimaPrepared *prep);
+
+CatimaResult catima_prepared_calculate(const CatimaPrepared *prep, double T);
+void catima_prepared_calculate_n(const CatimaPrepared *prep, const double *T, CatimaResult *res, size_t n);
+void catima_prepared_Eout_n(const CatimaPrepared *prep, const double *T, double *res, size_t n);
+void catima_prepared_range_n(const CatimaPrepared *prep, const double *T, double *res, size_t n);
+
 #ifdef __cplusplus
 }
 #endif
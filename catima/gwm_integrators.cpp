@@ -1,97 +1,200 @@
 /*
- * Simple energy  loss integrators for forward and reverse cases. 
+ * Simple energy  loss integrators for forward and reverse cases.
  *
  * Dec 2022, Gordon McCann
  */
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include "catima/gwm_integrators.h"
 
 namespace catima {
 
-    double integrate_energyloss(Projectile& proj, const Material& mat, const Config& c)
-    {
-        static double s_estep_max = 0.001;
-        static int s_depth_max = 100;
-        int depth = 0;
-        double e_in = proj.T; // MeV/u
-        double e_final = e_in;
-        double x_step = 0.25*mat.thickness(); //g/cm^2
-        double x_traversed = 0.0;
-        double e_step = dedx(proj, mat, c)*x_step;
-		double A_recip = 1.0/proj.A;
-
-        while(true)
-        {
-            if(e_step/e_final > s_estep_max && depth < s_depth_max)
-            {
-                ++depth;
-                x_step *= 0.5;
-                e_step = dedx(proj, mat, c)*x_step*A_recip;
-            }
-            else if(x_step + x_traversed >= mat.thickness())
-            {
-                x_step = mat.thickness() - x_traversed;
-                e_step = dedx(proj, mat, c)*x_step*A_recip;
-                e_final -= e_step;
-                proj.T = e_final;
-                return (e_in - e_final)*proj.A;
+namespace {
+    // Dormand-Prince 5(4) coefficients
+    constexpr double a21 = 1.0/5.0;
+    constexpr double a31 = 3.0/40.0, a32 = 9.0/40.0;
+    constexpr double a41 = 44.0/45.0, a42 = -56.0/15.0, a43 = 32.0/9.0;
+    constexpr double a51 = 19372.0/6561.0, a52 = -25360.0/2187.0, a53 = 64448.0/6561.0, a54 = -212.0/729.0;
+    constexpr double a61 = 9017.0/3168.0, a62 = -355.0/33.0, a63 = 46732.0/5247.0, a64 = 49.0/176.0, a65 = -5103.0/18656.0;
+    constexpr double b1 = 35.0/384.0, b3 = 500.0/1113.0, b4 = 125.0/192.0, b5 = -2187.0/6784.0, b6 = 11.0/84.0;
+    constexpr double e1 = 71.0/57600.0, e3 = -71.0/16695.0, e4 = 71.0/1920.0, e5 = -17253.0/339200.0, e6 = 22.0/525.0, e7 = -1.0/40.0;
+
+    /**
+     * integrates dT/dx = -direction*stopping(T) over thickness
+     * stopping(T) returns energy loss per nucleon per g/cm2
+     */
+    template<typename F>
+    IntegrationResult integrate(F&& stopping, double T0, double thickness, bool forward, const IntegrationSettings &s){
+        IntegrationResult res;
+        res.T = T0;
+        if(thickness<=0.0 || T0<Ezero){
+            res.stopped = forward && T0<Ezero;
+            if(res.stopped)res.T = 0.0;
+            return res;
+        }
+
+        const double sign = forward?-1.0:1.0;
+        bool valid = true;
+        auto f = [&](double T){
+            if(!(T>=Ezero)){
+                valid = false;
+                return 0.0;
             }
-            else if(depth == s_depth_max)
-            {
-                return e_in*proj.A;
+            res.nevals++;
+            return sign*stopping(T);
+        };
+
+        double T = T0;
+        double x = 0.0;
+        double k1 = f(T);
+        double h = std::min(thickness, 0.05*T/std::abs(k1)); // initial step ~5% energy change
+        int ntrials = 0;
+        while(x<thickness){
+            if(++ntrials>s.max_steps){
+                res.converged = false;
+                break;
             }
-            else if (e_final < 0.0)
-            {
-                return e_in * proj.A; //In case an integration step takes us below 0
+            const bool last = (h>=thickness-x);
+            if(last)h = thickness-x;
+
+            valid = true;
+            const double k2 = f(T + h*(a21*k1));
+            const double k3 = f(T + h*(a31*k1 + a32*k2));
+            const double k4 = f(T + h*(a41*k1 + a42*k2 + a43*k3));
+            const double k5 = f(T + h*(a51*k1 + a52*k2 + a53*k3 + a54*k4));
+            const double k6 = f(T + h*(a61*k1 + a62*k2 + a63*k3 + a64*k4 + a65*k5));
+            const double Tnew = T + h*(b1*k1 + b3*k3 + b4*k4 + b5*k5 + b6*k6);
+            const double k7 = f(Tnew);
+
+            if(!valid){ // energy dropped below Ezero within the step
+                if(h<1e-12*thickness){
+                    res.stopped = true;
+                    break;
+                }
+                h *= 0.25;
+                continue;
             }
-            else
-            {
-                e_step = dedx(proj, mat, c)*x_step*A_recip;
-                e_final -= e_step;
-                proj.T = e_final;
-                x_traversed += x_step;
+
+            const double err = std::abs(h*(e1*k1 + e3*k3 + e4*k4 + e5*k5 + e6*k6 + e7*k7));
+            const double scale = s.tolerance*std::max(std::abs(T), std::abs(Tnew));
+            if(err<=scale){
+                x = last?thickness:x+h;
+                T = Tnew;
+                k1 = k7;
+                res.nsteps++;
             }
+            double factor = (err>0.0)?0.9*std::pow(scale/err, 0.2):5.0;
+            h *= std::min(5.0, std::max(0.2, factor));
+        }
+
+        if(res.stopped){
+            res.T = 0.0;
+        }
+        else{
+            res.T = T;
         }
+        return res;
     }
 
-    double reverse_integrate_energyloss(Projectile& proj, const Material& mat, const Config& c)
-    {
-        static double s_estep_max = 0.001;
-        static int s_depth_max = 100;
-        int depth = 0;
-        double e_out = proj.T; //MeV/u
-        double e_initial = e_out;
-        double x_step = 0.25*mat.thickness(); //g/cm^2
-        double x_traversed = 0.0;
-        double e_step = dedx(proj, mat, c)*x_step;
-		double A_recip = 1.0/proj.A;
-        
-        while(true)
-        {
-            if(e_step/e_initial > s_estep_max && depth < s_depth_max)
-            {
-                ++depth;
-                x_step *= 0.5;
-                e_step = dedx(proj, mat, c)*x_step*A_recip;
-            }
-            else if(x_step + x_traversed >= mat.thickness())
-            {
-                x_step = mat.thickness() -  x_traversed;
-                e_step = dedx(proj, mat, c)*x_step;
-                e_initial += e_step*A_recip;
-                proj.T = e_initial;
-                return (e_initial - e_out)*proj.A;
-            }
-            else if(depth == s_depth_max)
-            {
-                return e_out*proj.A;
+    template<typename F>
+    IntegrationResult integrate_energyloss_impl(F&& stopping, const Projectile &proj, double T, const Material &mat, bool forward, const IntegrationSettings &s){
+        IntegrationResult res = integrate(stopping, T, mat.thickness(), forward, s);
+        if(forward){
+            res.Eloss = (T - res.T)*proj.A;
+        }
+        else{
+            res.Eloss = (res.T - T)*proj.A;
+        }
+        return res;
+    }
+
+    // range from the spline is used to skip the integration when the projectile stops
+    bool stops(const Interpolator &range_spline, double T, const Material &mat){
+        return range_spline(T)<=mat.thickness();
+    }
+
+    IntegrationResult stopped_result(const Projectile &proj, double T){
+        IntegrationResult res;
+        res.stopped = true;
+        res.Eloss = T*proj.A;
+        return res;
+    }
+
+    IntegrationResult integrate_single(const Projectile& proj, const Material& mat, bool forward, const IntegrationSettings &s, const Config& c){
+        if(s.use_spline){
+            auto data = _shared_storage.Get(proj, mat, c);
+            spline_type range_spline = get_range_spline(*data);
+            if(forward && stops(range_spline, proj.T, mat))return stopped_result(proj, proj.T);
+            return integrate_energyloss_impl([&](double T){return 1.0/range_spline.derivative(T);},
+                                             proj, proj.T, mat, forward, s);
+        }
+        Projectile p = proj;
+        const double A_recip = 1.0/proj.A;
+        return integrate_energyloss_impl([&](double T){return dedx(p(T), mat, c)*A_recip;},
+                                         proj, proj.T, mat, forward, s);
+    }
+
+    std::vector<IntegrationResult> integrate_batch(const Projectile& proj, const std::vector<double> &T, const Material& mat, bool forward,
+                                                   const IntegrationSettings &s, const Config& c, ThreadPool &pool){
+        std::vector<IntegrationResult> res(T.size());
+        if(T.empty())return res;
+        std::shared_ptr<const DataPoint> data;
+        if(s.use_spline)data = _shared_storage.Get(proj, mat, c);
+        pool.parallel_for(T.size(), [&](std::size_t i){
+            if(s.use_spline){
+                spline_type range_spline = get_range_spline(*data);
+                if(forward && stops(range_spline, T[i], mat)){
+                    res[i] = stopped_result(proj, T[i]);
+                    return;
+                }
+                res[i] = integrate_energyloss_impl([&](double e){return 1.0/range_spline.derivative(e);},
+                                                   proj, T[i], mat, forward, s);
             }
-            else
-            {
-                e_step = dedx(proj, mat, c)*x_step;
-                e_initial += e_step*A_recip;
-                proj.T = e_initial;
-                x_traversed += x_step;
+            else{
+                Projectile p = proj;
+                const double A_recip = 1.0/proj.A;
+                res[i] = integrate_energyloss_impl([&](double e){return dedx(p(e), mat, c)*A_recip;},
+                                                   proj, T[i], mat, forward, s);
             }
-        }
+            });
+        return res;
+    }
+}
+
+    IntegrationResult integrate_energyloss(const Projectile& proj, const Material& mat, const IntegrationSettings &s, const Config& c)
+    {
+        return integrate_single(proj, mat, true, s, c);
+    }
+
+    IntegrationResult reverse_integrate_energyloss(const Projectile& proj, const Material& mat, const IntegrationSettings &s, const Config& c)
+    {
+        return integrate_single(proj, mat, false, s, c);
+    }
+
+    std::vector<IntegrationResult> integrate_energyloss(const Projectile& proj, const std::vector<double> &T, const Material& mat,
+                                                        const IntegrationSettings &s, const Config& c, ThreadPool &pool)
+    {
+        return integrate_batch(proj, T, mat, true, s, c, pool);
+    }
+
+    std::vector<IntegrationResult> reverse_integrate_energyloss(const Projectile& proj, const std::vector<double> &T, const Material& mat,
+                                                                const IntegrationSettings &s, const Config& c, ThreadPool &pool)
+    {
+        return integrate_batch(proj, T, mat, false, s, c, pool);
+    }
+
+    double integrate_energyloss(Projectile& proj, const Material& mat, const Config& c)
+    {
+        IntegrationResult res = integrate_energyloss(proj, mat, IntegrationSettings(), c);
+        proj.T = res.T;
+        return res.Eloss;
+    }
+
+    double reverse_integrate_energyloss(Projectile& proj, const Material& mat, const Config& c)
+    {
+        IntegrationResult res = reverse_integrate_energyloss(proj, mat, IntegrationSettings(), c);
+        proj.T = res.T;
+        return res.Eloss;
     }
 }
@@ -1,17 +1,86 @@
 /*
- * Simple energy  loss integrators for forward and reverse cases. 
+ * Simple energy  loss integrators for forward and reverse cases.
  *
  * Dec 2022, Gordon McCann
  */
 #ifndef GWM_INTEGRATORS_H
 #define GWM_INTEGRATORS_H
 
+#include <vector>
 #include "catima/catima.h"
+#include "catima/thread_pool.h"
 
 namespace catima {
 
+    /**
+     * settings of the stepping energy loss integration
+     */
+    struct IntegrationSettings{
+        double tolerance = 1e-6; // relative error of the energy allowed per step
+        bool use_spline = false; // take stopping power from cached range spline instead of calling dedx
+        int max_steps = 100000;
+    };
+
+    /**
+     * result of the stepping energy loss integration
+     */
+    struct IntegrationResult{
+        double T = 0.0;      // final energy in MeV/u
+        double Eloss = 0.0;  // energy loss in MeV
+        int nsteps = 0;      // number of accepted steps
+        int nevals = 0;      // number of stopping power evaluations
+        bool stopped = false;
+        bool converged = true;
+    };
+
+    /**
+     * integrates energy loss through the material, adaptive Runge-Kutta (Dormand-Prince 5(4)) is used
+     * @param proj - Projectile, proj.T is the incoming energy
+     * @param mat - Material
+     * @param s - integration settings
+     * @return IntegrationResult, if projectile stops T is 0 and stopped is true
+     */
+    IntegrationResult integrate_energyloss(const Projectile& proj, const Material& mat, const IntegrationSettings &s, const Config& c=default_config);
+
+    /**
+     * integrates energy loss backwards through the material
+     * @param proj - Projectile, proj.T is the outcoming energy
+     * @param mat - Material
+     * @param s - integration settings
+     * @return IntegrationResult with incoming energy
+     */
+    IntegrationResult reverse_integrate_energyloss(const Projectile& proj, const Material& mat, const IntegrationSettings &s, const Config& c=default_config);
+
+    /**
+     * integrates energy loss for multiple energies in parallel
+     * @param T - vector of incoming energies
+     * @return vector of IntegrationResult, i-th result belongs to i-th energy
+     */
+    std::vector<IntegrationResult> integrate_energyloss(const Projectile& proj, const std::vector<double> &T, const Material& mat,
+                                                        const IntegrationSettings &s, const Config& c=default_config,
+                                                        ThreadPool &pool=default_thread_pool());
+
+    /**
+     * integrates energy loss backwards for multiple energies in parallel
+     * @param T - vector of outcoming energies
+     * @return vector of IntegrationResult, i-th result belongs to i-th energy
+     */
+    std::vector<IntegrationResult> reverse_integrate_energyloss(const Projectile& proj, const std::vector<double> &T, const Material& mat,
+                                                                const IntegrationSettings &s, const Config& c=default_config,
+                                                                ThreadPool &pool=default_thread_pool());
+
+    /**
+     * integrates energy loss through the material with default settings
+     * @param proj - Projectile, proj.T is set to the final energy
+     * @return energy loss in MeV, incoming energy*A if the projectile stops
+     */
     double integrate_energyloss(Projectile& proj, const Material& mat, const Config& c=default_config);
 
+    /**
+     * integrates energy loss backwards through the material with default settings
+     * @param proj - Projectile, proj.T is set to the incoming energy
+     * @return energy loss in MeV
+     */
     double reverse_integrate_energyloss(Projectile& proj, const Material& mat, const Config& c=default_config);
 }
 
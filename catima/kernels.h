@@ -0,0 +1,326 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/// \file kernels.h
+/// physics kernels templated on the configuration policy, see config_policy.h
+#ifndef CATIMA_KERNELS_H
+#define CATIMA_KERNELS_H
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+#include "catima/calculations.h"
+#include "catima/config_policy.h"
+#include "catima/constants.h"
+#include "catima/data_ionisation_potential.h"
+
+namespace catima{
+namespace kernels{
+
+    template<typename P>
+    double z_effective(const Projectile &p, const Target &t, const Config &c){
+        const unsigned char z_eff = P::z_effective(c);
+        if(z_eff == z_eff_type::none){
+            return p.Q;
+        }
+
+        double gamma=1.0 + p.T/atomic_mass_unit;
+        double beta = sqrt(1.0-1.0/(gamma*gamma));
+        if(z_eff == z_eff_type::pierce_blann){
+            return z_eff_Pierce_Blann(p.Z, beta);
+        }
+        else if(z_eff == z_eff_type::anthony_landorf){
+            return z_eff_Anthony_Landford(p.Z, beta, t.Z);
+        }
+        else if(z_eff == z_eff_type::hubert){
+            return z_eff_Hubert(p.Z, p.T, t.Z);
+        }
+        else if(z_eff == z_eff_type::winger){
+            return z_eff_Winger(p.Z, beta, t.Z);
+        }
+        else if(z_eff == z_eff_type::global){
+            return z_eff_global(p.Z, p.T, t.Z);
+        }
+        else if(z_eff == z_eff_type::atima14){
+            return z_eff_atima14(p.Z, p.T, t.Z);
+        }
+        else if(z_eff == z_eff_type::schiwietz){
+            return z_eff_Schiwietz(p.Z, beta, t.Z);
+        }
+        else{
+            assert(false);
+            return 0.0;
+        }
+    }
+
+    /// effective charge used by the stopping kernels, interpolated from the tables if built with ZEFF_TABLES
+    template<typename P>
+    double z_effective_stopping(const Projectile &p, const Target &t, const Config &c){
+#ifdef ZEFF_TABLES
+        const unsigned char z_eff = P::z_effective(c);
+        if(z_eff != z_eff_type::none && z_eff != z_eff_type::pierce_blann){
+            return z_eff_tabulated(z_eff, p.Z, p.T, t.Z);
+        }
+#endif
+        return z_effective<P>(p,t,c);
+    }
+
+    template<typename P>
+    double bethek_dedx_e(const Projectile &p, const Target &t, const Config &c, double I){
+        assert(t.Z>0 && p.Z>0);
+        assert(t.A>0 && p.A>0);
+        assert(p.T>0.0);
+        if(p.T==0)return 0.0;
+        const unsigned char cor_flags = P::corrections(c);
+        double gamma=1.0 + p.T/atomic_mass_unit;
+        double beta2=1.0-1.0/(gamma*gamma);
+        double beta = sqrt(beta2);
+        double zp_eff = z_effective_stopping<P>(p,t,c);
+        assert(zp_eff>=0);
+        double Ipot = (I>0.0)?I:ipot(t.Z);
+        assert(Ipot>0);
+        double f1 = dedx_constant*pow(zp_eff,2.0)*t.Z/(beta2*t.A);
+        double f2 = log(2.0*electron_mass*1000000*beta2/Ipot);
+
+        double eta = beta*gamma;
+        if(!(cor_flags&corrections::no_shell_correction) &&  eta>=0.13){ //shell corrections
+            double cor = (+0.422377*pow(eta,-2)
+                        +0.0304043*pow(eta,-4)
+                        -0.00038106*pow(eta,-6))*1e-6*pow(Ipot,2)
+                      +(+3.858019*pow(eta,-2)
+                        -0.1667989*(pow(eta,-4))
+                        +0.00157955*(pow(eta,-6)))*1.0e-9*pow(Ipot,3);
+            f2 = f2 -cor/t.Z;
+        }
+        f2+=2*log(gamma) -beta2;
+
+        double barkas=1.0;
+        if(!(cor_flags&corrections::no_barkas)){
+            barkas = bethek_barkas(zp_eff,eta,t.Z);
+            }
+
+        double delta = bethek_density_effect(beta, t.Z);
+
+        double LS = 0.0;
+        if(!(cor_flags&corrections::no_lindhard)){
+            LS = precalculated_lindhard(p);
+            }
+        double result  = (f2)*barkas + LS - delta/2.;
+        result *=f1;
+
+        if( (p.T>50000.0) && !(cor_flags&corrections::no_highenergy)){
+            result += pair_production(p,t);
+            result += bremsstrahlung(p,t);
+        }
+
+        return result;
+    }
+
+    template<typename P>
+    double bethek_dedx_e(const Projectile &p, const Material &mat, const Config &c){
+        double sum=0.0;
+        for(int i=0;i<mat.ncomponents();i++){
+            auto t = mat.get_element(i);
+            double w = mat.weight_fraction(i);
+            sum += w*bethek_dedx_e<P>(p,t,c,mat.I());
+        }
+        return sum;
+    }
+
+    template<typename P>
+    double dedx_variance(const Projectile &p, const Target &t, const Config &c){
+        double gamma = gamma_from_T(p.T);
+        double cor=0;
+        double beta = beta_from_T(p.T);
+        double beta2 = beta*beta;
+        double zp_eff = z_effective_stopping<P>(p,t,c);
+        double f = domega2dx_constant*ipow(zp_eff,2)*t.Z/t.A;
+
+        if( (P::calculation(c) == omega_types::atima) ){
+            cor = 24.89 * std::pow(t.Z,1.2324)/(electron_mass*1e6 * beta2)*
+                log( 2.0*electron_mass*1e6*beta2/(33.05*std::pow(t.Z,1.6364)));
+            cor = std::max(cor, 0.0 );
+        }
+        double X = precalculated_lindhard_X(p);
+        X *= gamma*gamma;
+        if(p.T<30.0)
+            return std::min(f*(X+cor), energy_straggling_firsov(p.Z, p.T, t.Z,t.A));
+        else
+            return f*(X+cor);
+    }
+
+    template<typename P>
+    double dedx(const Projectile &p, const Material &mat, const Config &c){
+        double sum = 0;
+        if(p.T<=0)return 0.0;
+        sum += dedx_n(p,mat);
+        double se=0;
+        if(p.T<=10){
+            se = sezi_dedx_e(p,mat,c );
+        }
+        else if(p.T>10 && p.T<30){
+            double factor = 0.05 * ( p.T - 10.0 );
+            se = (1-factor)*sezi_dedx_e(p,mat,c) + factor*bethek_dedx_e<P>(p,mat,c);
+        }
+        else {
+            se = bethek_dedx_e<P>(p,mat,c);
+        }
+        sum+=se;
+
+        return sum;
+    }
+
+    template<typename P>
+    double domega2dx(const Projectile &p, const Material &mat, const Config &c){
+        double sum = 0;
+        for(int i=0;i<mat.ncomponents();i++){
+            auto t= mat.get_element(i);
+            double w = mat.weight_fraction(i);
+            sum += w*dedx_variance<P>(p,t,c);
+        }
+        return sum;
+    }
+
+    /**
+      * batch kernels, evaluate n energies T of the same Projectile and store the results to res
+      * the target constants and the energy dependent projectile terms are calculated once per call
+      * instead of once per energy and target component
+      */
+    template<typename P>
+    void bethek_dedx_e(const Projectile &p, const Material &mat, const Config &c, const double *T, double *res, std::size_t n){
+        constexpr std::size_t chunk = 64;
+        const unsigned char cor_flags = P::corrections(c);
+        double LS[chunk];
+        double gamma[chunk];
+        double beta2[chunk];
+        double eta[chunk];
+        Projectile pp = p;
+        for(std::size_t i=0;i<n;i++)res[i] = 0.0;
+        for(std::size_t i0=0;i0<n;i0+=chunk){
+            const std::size_t m = std::min(chunk, n-i0);
+            const double *Tc = T+i0;
+            for(std::size_t k=0;k<m;k++){
+                gamma[k] = 1.0 + Tc[k]/atomic_mass_unit;
+                beta2[k] = 1.0-1.0/(gamma[k]*gamma[k]);
+                eta[k] = std::sqrt(beta2[k])*gamma[k];
+                LS[k] = 0.0;
+            }
+            if(!(cor_flags&corrections::no_lindhard)){
+                for(std::size_t k=0;k<m;k++)LS[k] = precalculated_lindhard(pp(Tc[k]));
+            }
+
+            for(int j=0;j<mat.ncomponents();j++){
+                const Target t = mat.get_element(j);
+                const double w = mat.weight_fraction(j);
+                const double Ipot = (mat.I()>0.0)?mat.I():ipot(t.Z);
+                const double Ipot2 = Ipot*Ipot;
+                const double Ipot3 = Ipot2*Ipot;
+                const double f1c = w*dedx_constant*t.Z/t.A;
+                const double f2c = 2.0*electron_mass*1000000/Ipot;
+                for(std::size_t k=0;k<m;k++){
+                    const double T_ = Tc[k];
+                    if(T_<=0.0)continue;
+                    const double zp_eff = z_effective_stopping<P>(pp(T_),t,c);
+                    const double f1 = f1c*zp_eff*zp_eff/beta2[k];
+                    double f2 = std::log(f2c*beta2[k]);
+                    if(!(cor_flags&corrections::no_shell_correction) && eta[k]>=0.13){
+                        const double e2 = 1.0/(eta[k]*eta[k]);
+                        const double e4 = e2*e2;
+                        const double e6 = e4*e2;
+                        const double cor = (+0.422377*e2 +0.0304043*e4 -0.00038106*e6)*1e-6*Ipot2
+                                          +(+3.858019*e2 -0.1667989*e4 +0.00157955*e6)*1.0e-9*Ipot3;
+                        f2 -= cor/t.Z;
+                    }
+                    f2 += 2*std::log(gamma[k]) - beta2[k];
+                    double barkas = 1.0;
+                    if(!(cor_flags&corrections::no_barkas)){
+                        barkas = bethek_barkas(zp_eff,eta[k],t.Z);
+                    }
+                    const double delta = bethek_density_effect(std::sqrt(beta2[k]), t.Z);
+                    double r = f1*(f2*barkas + LS[k] - delta/2.);
+                    if( (T_>50000.0) && !(cor_flags&corrections::no_highenergy)){
+                        r += w*(pair_production(pp,t) + bremsstrahlung(pp,t));
+                    }
+                    res[i0+k] += r;
+                }
+            }
+        }
+    }
+
+    template<typename P>
+    void domega2dx(const Projectile &p, const Material &mat, const Config &c, const double *T, double *res, std::size_t n){
+        const bool atima_cor = (P::calculation(c) == omega_types::atima);
+        Projectile pp = p;
+        for(std::size_t i=0;i<n;i++)res[i] = 0.0;
+        for(int j=0;j<mat.ncomponents();j++){
+            const Target t = mat.get_element(j);
+            const double w = mat.weight_fraction(j);
+            const double fc = domega2dx_constant*t.Z/t.A;
+            const double corc = 24.89 * std::pow(t.Z,1.2324)/(electron_mass*1e6);
+            const double corl = 2.0*electron_mass*1e6/(33.05*std::pow(t.Z,1.6364));
+            for(std::size_t k=0;k<n;k++){
+                pp.T = T[k];
+                const double gamma = gamma_from_T(T[k]);
+                const double beta2 = 1.0-1.0/(gamma*gamma);
+                const double zp_eff = z_effective_stopping<P>(pp,t,c);
+                const double f = fc*zp_eff*zp_eff;
+                double cor = 0.0;
+                if(atima_cor){
+                    cor = std::max(corc/beta2*std::log(corl*beta2), 0.0);
+                }
+                const double X = precalculated_lindhard_X(pp)*gamma*gamma;
+                double v = f*(X+cor);
+                if(T[k]<30.0)v = std::min(v, energy_straggling_firsov(p.Z, T[k], t.Z,t.A));
+                res[k] += w*v;
+            }
+        }
+    }
+
+    template<typename P>
+    void dedx(const Projectile &p, const Material &mat, const Config &c, const double *T, double *res, std::size_t n){
+        constexpr std::size_t chunk = 64;
+        double Tb[chunk];
+        double se[chunk];
+        std::size_t idx[chunk];
+        Projectile pp = p;
+        dedx_n(p, mat, T, res, n);
+        for(std::size_t i0=0;i0<n;i0+=chunk){
+            const std::size_t i1 = std::min(n, i0+chunk);
+            std::size_t m = 0;
+            for(std::size_t i=i0;i<i1;i++){
+                if(T[i]<=0.0){
+                    res[i] = 0.0;
+                    continue;
+                }
+                if(T[i]>10){
+                    idx[m] = i;
+                    Tb[m++] = T[i];
+                }
+                if(T[i]<30){
+                    const double factor = (T[i]<=10)?0.0:0.05*(T[i]-10.0);
+                    res[i] += (1-factor)*sezi_dedx_e(pp(T[i]),mat,c);
+                }
+            }
+            bethek_dedx_e<P>(p, mat, c, Tb, se, m);
+            for(std::size_t k=0;k<m;k++){
+                const double e = Tb[k];
+                const double factor = (e<30)?0.05*(e-10.0):1.0;
+                res[idx[k]] += factor*se[k];
+            }
+        }
+    }
+}
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include <cmath>
+#include "catima/layers_table.h"
+#include "catima/catima.h"
+#include "catima/thread_pool.h"
+
+namespace catima{
+
+LayersTable::LayersTable(const Projectile &_p, const Layers &_layers, const Config &_c, double _emax)
+    :p(_p), layers(_layers), c(_c), emax(_emax){
+    total_thickness_cm = layers.thickness_cm();
+    data.reserve(layers.num());
+    for(const Material &m:layers.get_materials()){
+        data.push_back(_shared_storage.Get(p, m, c));
+    }
+
+    // final energy using only range splines, used to find stopping threshold
+    auto energy_after = [&](double T){
+        double e = T;
+        for(int i=0;i<layers.num();i++){
+            const Material &m = layers.get_materials()[i];
+            if(m.thickness()==0)continue;
+            spline_type range_spline = get_range_spline(*data[i]);
+            e = energy_out(e, m.thickness(), range_spline);
+            if(e<Ezero)return 0.0;
+        }
+        return e;
+    };
+
+    // lowest energy with final energy above limit, emax if not reached
+    auto threshold_energy = [&](double limit){
+        if(energy_after(Ezero)>=limit)return Ezero;
+        double lo = Ezero;
+        double hi = emax;
+        for(int i=0;i<200 && (hi-lo)>numeric_epsilon*hi;i++){
+            double mid = 0.5*(lo+hi);
+            if(energy_after(mid)>=limit)hi = mid;
+            else lo = mid;
+        }
+        return hi;
+    };
+
+    logscale.fill(false);
+    if(emax<=Ezero || energy_after(emax)<Ezero){ // does not pass, table not used
+        emin = 0.0;
+        return;
+    }
+    eth = threshold_energy(Ezero);
+    if(eth==Ezero){
+        eth = 0.0;
+        emin = Ezero;
+    }
+    else{
+        emin = eth*(1.0+layers_table_margin);
+    }
+    if(emin>=emax){
+        emin = 0.0;
+        return;
+    }
+
+    // tabulated in log of the distance from the threshold, smooth close to the threshold
+    grid = std::make_unique<grid_type>(std::log(emin-eth), std::log(emax-eth));
+    for(auto &v:values)v.resize(layers_table_points);
+    default_thread_pool().parallel_for(layers_table_points, [&](std::size_t i){
+        double T = eth + std::exp((*grid)[i]);
+        if(i==0)T = emin;
+        if(i==layers_table_points-1)T = emax;
+        Result r = catima::calculate(data, T, {}, layers).total_result;
+        values[eout][i] = r.Eout;
+        values[sigma_e][i] = r.sigma_E;
+        values[sigma_a2][i] = r.sigma_a*r.sigma_a;
+        values[sigma_x2][i] = r.sigma_x*r.sigma_x;
+        values[cov][i] = r.cov;
+        values[tof][i] = r.tof;
+        }, 1);
+
+    // survival probability is not available when leaving the layers below emin_reaction,
+    // so it has its own grid starting at that threshold
+    #ifdef REACTIONS
+    esp = std::max(threshold_energy(emin_reaction), emin);
+    #else
+    esp = emax;
+    #endif
+    if(esp<emax){
+        grid_sp = std::make_unique<grid_type>(std::log(esp-eth), std::log(emax-eth));
+        default_thread_pool().parallel_for(layers_table_points, [&](std::size_t i){
+            double T = eth + std::exp((*grid_sp)[i]);
+            if(i==0)T = esp;
+            if(i==layers_table_points-1)T = emax;
+            values[sp][i] = catima::calculate(data, T, {}, layers).total_result.sp;
+            }, 1);
+    }
+    else{
+        grid_sp = std::make_unique<grid_type>(*grid);
+        values[sp].assign(layers_table_points, -1.0);
+    }
+
+    for(int k=0;k<num_observables;k++){
+        bool positive = true;
+        for(double v:values[k]){
+            if(!(v>0.0)){positive = false;break;}
+        }
+        logscale[k] = positive;
+        if(positive){
+            for(double &v:values[k])v = std::log(v);
+        }
+        splines[k] = cspline_special<grid_type>((k==sp)?*grid_sp:*grid, values[k]);
+    }
+}
+
+double LayersTable::value(int i, double u) const{
+    double v = splines[i](u);
+    return logscale[i]?std::exp(v):v;
+}
+
+Result LayersTable::calculate(double T, const Phasespace &ps) const{
+    return catima::calculate(data, T, ps, layers).total_result;
+}
+
+Result LayersTable::operator()(double T, const Phasespace &ps) const{
+    if(emin==0.0 || T<emin || T>emax){
+        return calculate(T, ps);
+    }
+    const double u = std::log(T-eth);
+    const double L = total_thickness_cm;
+    const double a2 = ps.sigma_a*ps.sigma_a;
+    Result res;
+    res.Ein = T;
+    res.Eout = value(eout, u);
+    res.Eloss = (T - res.Eout)*p.A;
+    res.sigma_E = value(sigma_e, u);
+    res.sigma_a = std::sqrt(a2 + value(sigma_a2, u));
+    // initial phasespace is drifted through total thickness
+    res.sigma_x = std::sqrt(std::abs(ps.sigma_x*ps.sigma_x + 2*L*ps.cov_x + a2*L*L + value(sigma_x2, u)));
+    res.cov = ps.cov_x + a2*L + value(cov, u);
+    res.tof = value(tof, u);
+    #ifdef REACTIONS
+    res.sp = (T<esp)?-1.0:value(sp, u);
+    #endif
+    return res;
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_LAYERS_TABLE_H
+#define CATIMA_LAYERS_TABLE_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include "catima/constants.h"
+#include "catima/structures.h"
+#include "catima/config.h"
+#include "catima/storage.h"
+#include "catima/spline.h"
+
+namespace catima{
+
+/**
+ * @brief precalculated total response of the Layers for single projectile
+ * The total observables are tabulated as a function of the initial energy,
+ * the evaluation is then one spline lookup per observable independent of number of layers.
+ * The table spans from just above the stopping threshold of the Layers to emax,
+ * outside of this range the full layer by layer calculation is used.
+ * The initial Phasespace is propagated analytically, so it does not need to be tabulated.
+ * Evaluation does not access global storage and can be called from multiple threads.
+ *
+ * Example usage:
+ * \code{.cpp}
+ * LayersTable table(p, layers);
+ * Result r = table(1000.0);
+ * \endcode
+ */
+class LayersTable{
+public:
+    /**
+     * @param p - Projectile
+     * @param layers - Layers
+     * @param c - Config
+     * @param emax - maximum tabulated energy in MeV/u
+     */
+    LayersTable(const Projectile &p, const Layers &layers, const Config &c=default_config, double emax=1e4);
+
+    /**
+     * returns total Result after passing all layers, equivalent to calculate(p(T), ps, layers, c).total_result
+     * @param T - initial energy in MeV/u
+     * @param ps - initial Phasespace
+     */
+    Result operator()(double T, const Phasespace &ps={}) const;
+
+    /// same as operator() but calculated without the table
+    Result calculate(double T, const Phasespace &ps={}) const;
+
+    /// minimum energy to pass all layers
+    double threshold() const {return eth;}
+
+    /// minimum energy covered by the table, 0 if particle does not pass the layers below emax
+    double get_min() const {return emin;}
+
+    /// maximum energy covered by the table
+    double get_max() const {return emax;}
+
+    const Projectile& get_projectile() const {return p;}
+    const Layers& get_layers() const {return layers;}
+    const Config& get_config() const {return c;}
+
+private:
+    using grid_type = LinearVArray<layers_table_points>;
+    enum observable{eout=0, sigma_e, sigma_a2, sigma_x2, cov, tof, sp, num_observables};
+
+    double value(int i, double u) const;
+
+    Projectile p;
+    Layers layers;
+    Config c;
+    std::vector<std::shared_ptr<const DataPoint>> data;
+    double eth = 0.0;
+    double emin = 0.0;
+    double emax = 0.0;
+    double esp = 0.0; // minimum energy with survival probability calculated
+    double total_thickness_cm = 0.0;
+    std::unique_ptr<grid_type> grid; // splines point to the grid and values, kept on heap so the table can be moved
+    std::unique_ptr<grid_type> grid_sp;
+    std::array<std::vector<double>, num_observables> values;
+    std::array<bool, num_observables> logscale;
+    std::array<cspline_special<grid_type>, num_observables> splines;
+};
+
+}
+#endif
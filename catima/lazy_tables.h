@@ -0,0 +1,111 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/// \file lazy_tables.h
+#ifndef CATIMA_LAZY_TABLES_H
+#define CATIMA_LAZY_TABLES_H
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace catima{
+
+    /**
+      * set of tables of a function tabulated on the logarithmic energy grid
+      * the i-th table is calculated on the first lookup, building is thread safe
+      * values are interpolated linearly in log10(E), grid cells where the interpolation
+      * at 17 checked points (16 subintervals and the cell edges) differs from the function by more than half
+      * of the tolerance (discontinuities, kinks) and energies outside of the grid are evaluated directly,
+      * the margin keeps the error between the checked points within the tolerance
+      */
+    class LazyLogTables{
+    public:
+        /**
+          * @param ntables - number of tables
+          * @param logemin - log10 of the minimum energy
+          * @param logemax - log10 of the maximum energy
+          * @param npoints - number of grid points of each table
+          * @param tolerance - maximum relative interpolation error at the checked points of the cell
+          */
+        LazyLogTables(std::size_t ntables, double logemin, double logemax, int npoints, double tolerance=1e-4)
+            :n(ntables), num(npoints), lmin(logemin), lmax(logemax),
+             step((logemax-logemin)/(npoints-1)), tol(tolerance),
+             flags(new std::once_flag[ntables]), tables(new std::unique_ptr<double[]>[ntables]){}
+
+        LazyLogTables(const LazyLogTables&) = delete;
+        LazyLogTables& operator=(const LazyLogTables&) = delete;
+
+        /**
+          * returns interpolated value of the i-th table
+          * @param i - table index
+          * @param E - energy
+          * @param f - function f(E) used to build the i-th table, must be the same for every lookup of the table
+          */
+        template<typename F>
+        double operator()(std::size_t i, double E, F&& f) const{
+            if(!(E>0.0))return f(E);
+            const double x = (std::log10(E)-lmin)/step;
+            if(x<0.0 || x>(num-1))return f(E);
+            const double *t = table(i, f);
+            int k = static_cast<int>(x);
+            if(k>=num-1)k = num-2;
+            if(t[num+k]!=0.0)return f(E);
+            const double d = x-k;
+            return t[k] + d*(t[k+1]-t[k]);
+        }
+
+        /// energy of the j-th grid point
+        double energy(int j) const {return std::pow(10.0, lmin + j*step);}
+
+        std::size_t ntables() const {return n;}
+        int npoints() const {return num;}
+
+    private:
+        static constexpr int check_points = 16; // number of subintervals of the checked cell
+        static constexpr double check_margin = 0.5; // fraction of the tolerance required at the checked points
+        // table layout: num values followed by num-1 flags of directly evaluated cells
+        template<typename F>
+        const double* table(std::size_t i, F& f) const{
+            std::call_once(flags[i], [&](){
+                std::unique_ptr<double[]> t(new double[2*num-1]);
+                for(int j=0;j<num;j++)t[j] = f(energy(j));
+                for(int j=0;j<num-1;j++){
+                    t[num+j] = 0.0;
+                    for(int s=0;s<=check_points;s++){
+                        // points next to the grid nodes catch jumps located at the node
+                        const double d = std::min(std::max(static_cast<double>(s)/check_points, 1e-6), 1.0-1e-6);
+                        const double v = f(std::pow(10.0, lmin + (j+d)*step));
+                        const double ip = t[j] + d*(t[j+1]-t[j]);
+                        if(std::abs(ip-v) > check_margin*tol*std::abs(v))t[num+j] = 1.0;
+                    }
+                }
+                tables[i] = std::move(t);
+                });
+            return tables[i].get();
+        }
+
+        std::size_t n;
+        int num;
+        double lmin;
+        double lmax;
+        double step;
+        double tol;
+        std::unique_ptr<std::once_flag[]> flags;
+        std::unique_ptr<std::unique_ptr<double[]>[]> tables;
+    };
+}
+
+#endif
@@ -1,167 +1,456 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include "catima/material_database.h"
 #include "catima/nucdata.h"
 
 namespace catima{
 
-    Material get_material(int id){
+namespace{
+    // components of the predefined compounds, A=0 means the elemental atomic weight
+    constexpr MaterialComponent compound_components[] = {
+        {0,1,10},{0,6,9}, // Plastics
+        {0,7,0.755267},{0,8,0.231781},{0,18,0.012827},{0,6,0.000124}, // Air
+        {0,6,1},{0,1,2}, // CH2
+        {0,1,1}, // lH2
+        {2.0141,1,1}, // lD2
+        {0,1,2},{0,8,1}, // Water
+        {0,6,1}, // Diamond
+        {0,14,0.37722},{0,8,0.539562},{0,5,0.040064},{0,11,0.028191},{0,13,0.011644},{0,19,0.003321}, // Glass
+        {0,13,0.97},{0,12,0.03}, // ALMG3
+        {0,18,0.679},{0,8,0.2321},{0,6,0.0889}, // ArCO2_30
+        {0,6,1},{0,9,4}, // CF4
+        {0,6,4},{0,1,10}, // Isobutane
+        {0,1,0.026362},{0,6,0.691133},{0,7,0.07327},{0,8,0.209235}, // Kapton
+        {0,6,10},{0,1,8},{0,8,4}, // Mylar
+        {0,11,1},{0,9,1}, // NaF
+        {0,18,9},{0,6,1},{0,1,4}, // P10
+        {0,8,8},{0,1,16}, // Polyolefin
+        {0,96,1},{0,8,2}, // CmO2
+        {0,14,0.37722},{0,8,0.539562},{0,5,0.040064},{0,11,0.028191},{0,13,0.011644},{0,19,0.003321}, // Suprasil
+        {0,27,0.403228},{0,24,0.169412},{0,28,0.124301},{0,74,0.089847},{0,42,0.031259},{0,26,0.181952}, // HAVAR
+        {0,26,0.74621},{0,24,0.169},{0,28,0.08479}, // Steel
+        {0,6,1},{0,8,2}, // CO2
+        {0,1,4},{0,6,1}, // Methane
+        {0,1,4},{0,6,1},{0,8,1}, // Methanol
+        {0,1,6},{0,6,3},{0,8,1}, // Acetone
+        {0,1,2},{0,6,2}, // Acetylene
+        {0,1,5},{0,6,5},{0,7,5}, // Adenine
+        {0,1,0.119477},{0,6,0.63724},{0,7,0.00797},{0,8,0.232333},{0,11,0.0005},{0,12,2e-05},{0,15,0.00016},{0,16,0.00073},{0,17,0.00119},{0,19,0.00032},{0,20,2e-05},{0,26,2e-05},{0,30,2e-05}, // Adipose_Tissue
+        {0,1,7},{0,6,3},{0,7,1},{0,8,2}, // Alanine
+        {0,1,0.057441},{0,6,0.774591},{0,8,0.167968}, // Bakelite
+        {0,47,1},{0,35,1}, // AgBr
+        {0,47,1},{0,17,1}, // AgCl
+        {0,47,1},{0,53,1}, // AgI
+        {0,8,3},{0,13,2}, // Al2O3
+        {0,1,0.10593},{0,6,0.788974},{0,8,0.105096}, // Amber
+        {0,1,3},{0,7,1}, // Ammonia
+        {0,1,7},{0,6,6},{0,7,1}, // Aniline
+        {0,1,10},{0,6,14}, // Anthracene
+        {0,1,0.101327},{0,6,0.7755},{0,7,0.035057},{0,8,0.0523159},{0,9,0.017422},{0,20,0.018378}, // A_150
+        {0,1,0.0654709},{0,6,0.536944},{0,7,0.0215},{0,8,0.032085},{0,9,0.167411},{0,20,0.176589}, // B_100
+        {0,9,2},{0,56,1}, // BaF2
+        {0,8,4},{0,16,1},{0,56,1}, // BaSO4
+        {0,1,6},{0,6,6}, // Benzene
+        {0,4,1},{0,8,1}, // BeO
+        {0,8,12},{0,32,3},{0,83,4}, // BGO
+        {0,1,0.101866},{0,6,0.10002},{0,7,0.02964},{0,8,0.759414},{0,11,0.00185},{0,12,4e-05},{0,14,3e-05},{0,15,0.00035},{0,16,0.00185},{0,17,0.00278},{0,19,0.00163},{0,20,6e-05},{0,26,0.00046},{0,30,1e-05}, // Blood_ICRP
+        {0,1,0.063984},{0,6,0.278},{0,7,0.027},{0,8,0.410016},{0,12,0.002},{0,15,0.07},{0,16,0.002},{0,20,0.147}, // Bone_Compact
+        {0,1,0.047234},{0,6,0.14433},{0,7,0.04199},{0,8,0.446096},{0,12,0.0022},{0,15,0.10497},{0,16,0.00315},{0,20,0.20993},{0,30,0.0001}, // Bone_Cortical
+        {0,1,0.110667},{0,6,0.12542},{0,7,0.01328},{0,8,0.737723},{0,11,0.00184},{0,12,0.00015},{0,15,0.00354},{0,16,0.00177},{0,17,0.00236},{0,19,0.0031},{0,20,9e-05},{0,26,5e-05},{0,30,1e-05}, // Brain_ICRP
+        {0,5,4},{0,6,1}, // B4C
+        {0,1,10},{0,6,9}, // BC_400
+        {0,1,10},{0,6,4},{0,8,1}, // nButanol
+        {0,1,0.02468},{0,6,0.50161},{0,8,0.004527},{0,9,0.465209},{0,14,0.003973}, // C_552
+        {0,48,1},{0,52,1}, // CdTe
+        {0,8,4},{0,48,1},{0,74,1}, // CdWO4
+        {0,6,1},{0,8,3},{0,20,1}, // CaCO3
+        {0,9,2},{0,20,1}, // CaF2
+        {0,8,1},{0,20,1}, // CaO
+        {0,8,4},{0,20,1},{0,74,1}, // CaWO4
+        {0,9,1},{0,55,1}, // CsF
+        {0,53,1},{0,55,1}, // CsI
+        {0,6,1},{0,17,4}, // CCl4
+        {0,6,2},{0,17,4}, // Tetrachloroethylene
+        {0,1,0.062162},{0,6,0.444462},{0,8,0.493376}, // Cellophane
+        {0,1,5},{0,6,6},{0,17,1}, // Chlorobenzene
+        {0,1,1},{0,6,1},{0,17,3}, // Chloroform
+        {0,1,12},{0,6,6}, // Cyclohexane
+        {0,1,0.01},{0,6,0.001},{0,8,0.529107},{0,11,0.016},{0,12,0.002},{0,13,0.033872},{0,14,0.337021},{0,19,0.013},{0,20,0.044},{0,26,0.014}, // Concrete
+        {0,1,10},{0,6,4},{0,8,1}, // Diethyl_Ether
+        {0,1,6},{0,6,2}, // Ethane
+        {0,1,6},{0,6,2},{0,8,1}, // Ethanol
+        {0,1,4},{0,6,2}, // Ethylene
+        {0,1,0.099269},{0,6,0.19371},{0,7,0.05327},{0,8,0.653751}, // Eye_lens
+        {0,8,3},{0,26,2}, // Fe2O3
+        {0,8,1},{0,26,1}, // FeO
+        {0,6,1},{0,9,2},{0,17,2}, // Freon_12
+        {0,6,1},{0,9,2},{0,35,2}, // Freon_12B2
+        {0,6,1},{0,9,3},{0,17,1}, // Freon_13
+        {0,6,1},{0,9,3},{0,35,1}, // Freon_13B1
+        {0,6,1},{0,9,3},{0,53,1}, // Freon_13I1
+        {0,8,2},{0,16,1},{0,64,2}, // Gd2O2S
+        {0,31,1},{0,33,1}, // GaAs
+        {0,1,0.08118},{0,6,0.41606},{0,7,0.11124},{0,8,0.38064},{0,16,0.01088}, // Gel_Photo_Emulsion
+        {0,5,0.0400639},{0,8,0.539561},{0,11,0.0281909},{0,13,0.011644},{0,14,0.377219},{0,19,0.00332099}, // Glass_Pyrex
+        {0,8,0.156453},{0,14,0.080866},{0,22,0.008092},{0,33,0.002651},{0,82,0.751938}, // Glass_Lead
+        {0,1,12},{0,6,6},{0,8,6}, // Glucose
+        {0,1,10},{0,6,5},{0,7,2},{0,8,3}, // Glutamine
+        {0,1,8},{0,6,3},{0,8,3}, // Glycerol
+        {0,1,5},{0,6,5},{0,7,5},{0,8,1}, // Guanine
+        {0,1,0.023416},{0,8,0.557572},{0,16,0.186215},{0,20,0.232797}, // Gypsum
+        {0,1,16},{0,6,7}, // nHeptane
+        {0,1,14},{0,6,6}, // nHexane
+        {0,19,1},{0,53,1}, // KI
+        {0,8,1},{0,19,2}, // K2O
+        {0,57,1},{0,35,3}, // LaBr3
+        {0,8,1},{0,35,1},{0,57,1}, // LaOBr
+        {0,8,2},{0,16,1},{0,57,2}, // La2O2S
+        {0,1,0.101278},{0,6,0.10231},{0,7,0.02865},{0,8,0.757072},{0,11,0.00184},{0,12,0.00073},{0,15,0.0008},{0,16,0.00225},{0,17,0.00266},{0,19,0.00194},{0,20,9e-05},{0,26,0.00037},{0,30,1e-05}, // Lung
+        {0,12,1},{0,6,1},{0,8,3}, // MgCO3
+        {0,12,1},{0,9,2}, // MgF2
+        {0,12,1},{0,8,1}, // MgO
+        {0,1,0.081192},{0,6,0.583442},{0,7,0.017798},{0,8,0.186381},{0,12,0.130287},{0,17,0.0009}, // MS20_Tissue
+        {0,1,0.100637},{0,6,0.10783},{0,7,0.02768},{0,8,0.754773},{0,11,0.00075},{0,12,0.00019},{0,15,0.0018},{0,16,0.00241},{0,17,0.00079},{0,19,0.00302},{0,20,3e-05},{0,26,4e-05},{0,30,5e-05}, // Muscle_skeletal
+        {0,1,0.101997},{0,6,0.123},{0,7,0.035},{0,8,0.729003},{0,11,0.0008},{0,12,0.0002},{0,15,0.002},{0,16,0.005},{0,19,0.003}, // Muscle_strained
+        {0,1,0.0982341},{0,6,0.156214},{0,7,0.035451},{0,8,0.710101}, // Muscle_sucrose
+        {0,1,0.101969},{0,6,0.120058},{0,7,0.035451},{0,8,0.742522}, // Muscle_no_sucrose
+        {0,6,1},{0,8,3},{0,11,1}, // Na2CO3
+        {0,11,1},{0,53,1}, // NaI
+        {0,11,1},{0,17,1}, // NaCl
+        {0,8,1},{0,11,2}, // Na2O
+        {0,7,1},{0,8,3},{0,11,1}, // NaNO3
+        {0,1,8},{0,6,10}, // Naphthalene
+        {0,1,5},{0,6,6},{0,7,1},{0,8,2}, // Nitrobenzene
+        {0,7,2},{0,8,1}, // N2O
+        {0,1,18},{0,6,8}, // Octane
+        {0,1,0.148605},{0,6,0.851395}, // Paraffin
+        {0,1,12},{0,6,5}, // nPentane
+        {0,1,0.0141},{0,6,0.072261},{0,7,0.01932},{0,8,0.066101},{0,16,0.00189},{0,35,0.349103},{0,47,0.474105}, // PhotoEmulsion
+        {0,8,2},{0,94,1}, // PuO2
+        {0,1,3},{0,6,3},{0,7,1}, // Polyacrylonitrile
+        {0,1,0.055491},{0,6,0.755751},{0,8,0.188758}, // Polycarbonate
+        {0,1,8},{0,6,5},{0,8,2}, // PMMA
+        {0,1,2},{0,6,1},{0,8,1}, // POM
+        {0,6,3},{0,1,6}, // Polypropylene
+        {0,6,8},{0,1,8}, // Polystyrene
+        {0,1,8},{0,6,3}, // Propane
+        {0,1,8},{0,6,3},{0,8,1}, // nPropanol
+        {0,1,3},{0,6,2},{0,17,1}, // PVC
+        {0,1,5},{0,6,5},{0,7,1}, // Pyridine
+        {0,8,2},{0,14,1}, // SiO2
+        {0,1,0.100588},{0,6,0.22825},{0,7,0.04642},{0,8,0.619002},{0,11,7e-05},{0,12,6e-05},{0,15,0.00033},{0,16,0.00159},{0,17,0.00267},{0,19,0.00085},{0,20,0.00015},{0,26,1e-05},{0,30,1e-05}, // Skin
+        {0,1,22},{0,6,12},{0,8,11}, // Sucrose
+        {0,6,2},{0,9,4}, // Teflon
+        {0,17,1},{0,81,1}, // TlCl
+        {0,1,8},{0,6,7}, // Toluene
+        {0,1,1},{0,6,2},{0,17,3}, // Trichloroethylene
+        {0,9,6},{0,74,1}, // WF6
+        {0,6,2},{0,92,1}, // UC2
+        {0,6,1},{0,92,1}, // UC
+        {0,8,2},{0,92,1}, // UO2
+        {0,1,0.067131},{0,6,0.2},{0,7,0.466459},{0,8,0.266411}, // Urea
+        {0,1,11},{0,6,5},{0,7,1},{0,8,2}, // Valine
+        {0,6,10},{0,1,7},{0,53,1}, // Iodonaphthalene
+        {0,6,21},{0,1,24},{0,8,4}, // C21H24O4
+        {0,27,17},{0,75,23},{0,24,1}, // CoRe_Alloy
+        {0,3,7},{0,57,3},{0,40,2},{0,8,12}, // LLZO_electrolyte
+        {0,6,6},{0,1,11},{0,7,1},{0,8,1}, // Nylon
+    };
+
+    // predefined compounds ordered by id
+    constexpr MaterialRecord compound_records[] = {
+        {material::Plastics, "Plastics", 1.032, 0, 2},
+        {material::Air, "Air", 0.001205, 2, 4},
+        {material::CH2, "CH2", 0.94, 6, 2},
+        {material::lH2, "lH2", 0.0708, 8, 1},
+        {material::lD2, "lD2", 0.162, 9, 1},
+        {material::Water, "Water", 1, 10, 2},
+        {material::Diamond, "Diamond", 3.52, 12, 1},
+        {material::Glass, "Glass", 2.4, 13, 6},
+        {material::ALMG3, "ALMG3", 2.67, 19, 2},
+        {material::ArCO2_30, "ArCO2_30", 0.00171, 21, 3},
+        {material::CF4, "CF4", 0.00372, 24, 2},
+        {material::Isobutane, "Isobutane", 0.00251, 26, 2},
+        {material::Kapton, "Kapton", 1.42, 28, 4},
+        {material::Mylar, "Mylar", 1.38, 32, 3},
+        {material::NaF, "NaF", 2.56, 35, 2},
+        {material::P10, "P10", 0.00166, 37, 3},
+        {material::Polyolefin, "Polyolefin", 0.9, 40, 2},
+        {material::CmO2, "CmO2", 12, 42, 2},
+        {material::Suprasil, "Suprasil", 2.2, 44, 6},
+        {material::HAVAR, "HAVAR", 8.3, 50, 6},
+        {material::Steel, "Steel", 8, 56, 3},
+        {material::CO2, "CO2", 0.001842, 59, 2},
+        {material::Methane, "Methane", 0.0006, 61, 2},
+        {material::Methanol, "Methanol", 0.792, 63, 3},
+        {material::Acetone, "Acetone", 0.7899, 66, 3},
+        {material::Acetylene, "Acetylene", 0.0010967, 69, 2},
+        {material::Adenine, "Adenine", 1.35, 71, 3},
+        {material::Adipose_Tissue, "Adipose_Tissue", 0.92, 74, 13},
+        {material::Alanine, "Alanine", 1.42, 87, 4},
+        {material::Bakelite, "Bakelite", 1.25, 91, 3},
+        {material::AgBr, "AgBr", 6.473, 94, 2},
+        {material::AgCl, "AgCl", 5.56, 96, 2},
+        {material::AgI, "AgI", 5.675, 98, 2},
+        {material::Al2O3, "Al2O3", 3.97, 100, 2},
+        {material::Amber, "Amber", 1.1, 102, 3},
+        {material::Ammonia, "Ammonia", 0.000826, 105, 2},
+        {material::Aniline, "Aniline", 1.0235, 107, 3},
+        {material::Anthracene, "Anthracene", 1.283, 110, 2},
+        {material::A_150, "A_150", 1.127, 112, 6},
+        {material::B_100, "B_100", 1.45, 118, 6},
+        {material::BaF2, "BaF2", 4.89, 124, 2},
+        {material::BaSO4, "BaSO4", 4.5, 126, 3},
+        {material::Benzene, "Benzene", 0.87865, 129, 2},
+        {material::BeO, "BeO", 3.01, 131, 2},
+        {material::BGO, "BGO", 7.13, 133, 3},
+        {material::Blood_ICRP, "Blood_ICRP", 1.06, 136, 14},
+        {material::Bone_Compact, "Bone_Compact", 1.85, 150, 8},
+        {material::Bone_Cortical, "Bone_Cortical", 1.85, 158, 9},
+        {material::Brain_ICRP, "Brain_ICRP", 1.03, 167, 13},
+        {material::B4C, "B4C", 2.52, 180, 2},
+        {material::BC_400, "BC_400", 1.032, 182, 2},
+        {material::nButanol, "nButanol", 0.81, 184, 3},
+        {material::C_552, "C_552", 1.76, 187, 5},
+        {material::CdTe, "CdTe", 6.2, 192, 2},
+        {material::CdWO4, "CdWO4", 7.9, 194, 3},
+        {material::CaCO3, "CaCO3", 2.8, 197, 3},
+        {material::CaF2, "CaF2", 3.18, 200, 2},
+        {material::CaO, "CaO", 3.34, 202, 2},
+        {material::CaWO4, "CaWO4", 6.062, 204, 3},
+        {material::CsF, "CsF", 4.115, 207, 2},
+        {material::CsI, "CsI", 4.51, 209, 2},
+        {material::CCl4, "CCl4", 1.594, 211, 2},
+        {material::Tetrachloroethylene, "Tetrachloroethylene", 1.622, 213, 2},
+        {material::Cellophane, "Cellophane", 1.42, 215, 3},
+        {material::Chlorobenzene, "Chlorobenzene", 1.1058, 218, 3},
+        {material::Chloroform, "Chloroform", 1.4832, 221, 3},
+        {material::Cyclohexane, "Cyclohexane", 0.779, 224, 2},
+        {material::Concrete, "Concrete", 2.3, 226, 10},
+        {material::Diethyl_Ether, "Diethyl_Ether", 0.71378, 236, 3},
+        {material::Ethane, "Ethane", 0.00125324, 239, 2},
+        {material::Ethanol, "Ethanol", 0.7893, 241, 3},
+        {material::Ethylene, "Ethylene", 0.00117497, 244, 2},
+        {material::Eye_lens, "Eye_lens", 1.1, 246, 4},
+        {material::Fe2O3, "Fe2O3", 5.242, 250, 2},
+        {material::FeO, "FeO", 5.745, 252, 2},
+        {material::Freon_12, "Freon_12", 1.486, 254, 3},
+        {material::Freon_12B2, "Freon_12B2", 2.27, 257, 3},
+        {material::Freon_13, "Freon_13", 1.526, 260, 3},
+        {material::Freon_13B1, "Freon_13B1", 1.538, 263, 3},
+        {material::Freon_13I1, "Freon_13I1", 1.538, 266, 3},
+        {material::Gd2O2S, "Gd2O2S", 7.44, 269, 3},
+        {material::GaAs, "GaAs", 5.3176, 272, 2},
+        {material::Gel_Photo_Emulsion, "Gel_Photo_Emulsion", 1.2914, 274, 5},
+        {material::Glass_Pyrex, "Glass_Pyrex", 2.23, 279, 6},
+        {material::Glass_Lead, "Glass_Lead", 6.22, 285, 5},
+        {material::Glucose, "Glucose", 1.54, 290, 3},
+        {material::Glutamine, "Glutamine", 1.46, 293, 4},
+        {material::Glycerol, "Glycerol", 1.2613, 297, 3},
+        {material::Guanine, "Guanine", 1.58, 300, 4},
+        {material::Gypsum, "Gypsum", 2.32, 304, 4},
+        {material::nHeptane, "nHeptane", 0.68376, 308, 2},
+        {material::nHexane, "nHexane", 0.66603, 310, 2},
+        {material::KI, "KI", 3.13, 312, 2},
+        {material::K2O, "K2O", 2.32, 314, 2},
+        {material::LaBr3, "LaBr3", 5.06, 316, 2},
+        {material::LaOBr, "LaOBr", 6.28, 318, 3},
+        {material::La2O2S, "La2O2S", 5.86, 321, 3},
+        {material::Lung, "Lung", 1.05, 324, 13},
+        {material::MgCO3, "MgCO3", 2.958, 337, 3},
+        {material::MgF2, "MgF2", 3.148, 340, 2},
+        {material::MgO, "MgO", 3.6, 342, 2},
+        {material::MS20_Tissue, "MS20_Tissue", 1, 344, 6},
+        {material::Muscle_skeletal, "Muscle_skeletal", 1.04, 350, 13},
+        {material::Muscle_strained, "Muscle_strained", 1.04, 363, 9},
+        {material::Muscle_sucrose, "Muscle_sucrose", 1.11, 372, 4},
+        {material::Muscle_no_sucrose, "Muscle_no_sucrose", 1.07, 376, 4},
+        {material::Na2CO3, "Na2CO3", 2.532, 380, 3},
+        {material::NaI, "NaI", 3.667, 383, 2},
+        {material::NaCl, "NaCl", 2.165, 385, 2},
+        {material::Na2O, "Na2O", 2.27, 387, 2},
+        {material::NaNO3, "NaNO3", 2.261, 389, 3},
+        {material::Naphthalene, "Naphthalene", 1.145, 392, 2},
+        {material::Nitrobenzene, "Nitrobenzene", 1.199, 394, 4},
+        {material::N2O, "N2O", 0.00183, 398, 2},
+        {material::Octane, "Octane", 0.703, 400, 2},
+        {material::Paraffin, "Paraffin", 0.93, 402, 2},
+        {material::nPentane, "nPentane", 0.626, 404, 2},
+        {material::PhotoEmulsion, "PhotoEmulsion", 3.815, 406, 7},
+        {material::PuO2, "PuO2", 11.46, 413, 2},
+        {material::Polyacrylonitrile, "Polyacrylonitrile", 1.184, 415, 3},
+        {material::Polycarbonate, "Polycarbonate", 1.2, 418, 3},
+        {material::PMMA, "PMMA", 1.18, 421, 3},
+        {material::POM, "POM", 1.42, 424, 3},
+        {material::Polypropylene, "Polypropylene", 0.9, 427, 2},
+        {material::Polystyrene, "Polystyrene", 1.06, 429, 2},
+        {material::Propane, "Propane", 0.00188, 431, 2},
+        {material::nPropanol, "nPropanol", 0.8035, 433, 3},
+        {material::PVC, "PVC", 1.3, 436, 3},
+        {material::Pyridine, "Pyridine", 0.9819, 439, 3},
+        {material::SiO2, "SiO2", 2.32, 442, 2},
+        {material::Skin, "Skin", 1.1, 444, 13},
+        {material::Sucrose, "Sucrose", 1.587, 457, 3},
+        {material::Teflon, "Teflon", 2.2, 460, 2},
+        {material::TlCl, "TlCl", 7.004, 462, 2},
+        {material::Toluene, "Toluene", 0.8669, 464, 2},
+        {material::Trichloroethylene, "Trichloroethylene", 1.46, 466, 3},
+        {material::WF6, "WF6", 2.4, 469, 2},
+        {material::UC2, "UC2", 11.28, 471, 2},
+        {material::UC, "UC", 13.63, 473, 2},
+        {material::UO2, "UO2", 10.97, 475, 2},
+        {material::Urea, "Urea", 1.323, 477, 4},
+        {material::Valine, "Valine", 1.23, 481, 4},
+        {material::Iodonaphthalene, "Iodonaphthalene", 1.738, 485, 3},
+        {material::C21H24O4, "C21H24O4", 1.18, 488, 3},
+        {material::CoRe_Alloy, "CoRe_Alloy", 11.5, 491, 3},
+        {material::LLZO_electrolyte, "LLZO_electrolyte", 5.1, 494, 4},
+        {material::Nylon, "Nylon", 1.14, 498, 4},
+    };
+
+    constexpr int compound_min_id = static_cast<int>(material::Plastics);
+    constexpr std::size_t ncompounds = sizeof(compound_records)/sizeof(compound_records[0]);
+
+    constexpr bool records_ordered(){
+        for(std::size_t i=0;i<ncompounds;i++){
+            if(static_cast<int>(compound_records[i].id) != compound_min_id+static_cast<int>(i))return false;
+        }
+        return true;
+    }
+    static_assert(records_ordered(), "compound records must be ordered by contiguous id");
+
+    // perfect hash of the compound names (hash and displace), built at compile time
+    constexpr std::uint64_t name_hash(const char *s, std::uint64_t seed){
+        std::uint64_t h = 14695981039346656037ull ^ (seed*0x9E3779B97F4A7C15ull);
+        for(;*s;++s){
+            h ^= static_cast<unsigned char>(*s);
+            h *= 1099511628211ull;
+        }
+        return h ^ (h>>29);
+    }
+
+    constexpr std::size_t name_hash_buckets = 64;
+    constexpr std::size_t name_hash_slots = 256;
+    static_assert(ncompounds < name_hash_slots, "increase name_hash_slots");
+
+    struct NameHash{
+        std::array<unsigned short, name_hash_buckets> displacement{};
+        std::array<short, name_hash_slots> index{};
+        bool ok = false;
+    };
+
+    constexpr NameHash build_name_hash(){
+        NameHash t;
+        for(auto &i:t.index)i = -1;
+        std::array<std::size_t, name_hash_buckets> bucket_size{};
+        std::size_t max_size = 0;
+        for(std::size_t i=0;i<ncompounds;i++){
+            std::size_t b = name_hash(compound_records[i].name, 0)%name_hash_buckets;
+            bucket_size[b]++;
+            if(bucket_size[b]>max_size)max_size = bucket_size[b];
+        }
+        // the largest buckets are placed first
+        for(std::size_t size=max_size;size>0;size--){
+            for(std::size_t b=0;b<name_hash_buckets;b++){
+                if(bucket_size[b]!=size)continue;
+                std::array<std::size_t, name_hash_slots> slots{};
+                bool placed = false;
+                for(unsigned short d=1;d<65535 && !placed;d++){
+                    std::size_t k = 0;
+                    bool free = true;
+                    for(std::size_t i=0;i<ncompounds && free;i++){
+                        if(name_hash(compound_records[i].name, 0)%name_hash_buckets != b)continue;
+                        std::size_t s = name_hash(compound_records[i].name, d)%name_hash_slots;
+                        if(t.index[s]>=0)free = false;
+                        for(std::size_t j=0;j<k;j++)if(slots[j]==s)free = false;
+                        slots[k++] = s;
+                    }
+                    if(!free)continue;
+                    k = 0;
+                    for(std::size_t i=0;i<ncompounds;i++){
+                        if(name_hash(compound_records[i].name, 0)%name_hash_buckets != b)continue;
+                        t.index[slots[k++]] = static_cast<short>(i);
+                    }
+                    t.displacement[b] = d;
+                    placed = true;
+                }
+                if(!placed)return t;
+            }
+        }
+        t.ok = true;
+        return t;
+    }
+
+    constexpr NameHash name_hash_table = build_name_hash();
+    static_assert(name_hash_table.ok, "perfect hash of material names not found");
+
+    const MaterialRecord* find_record(int id){
+        const int i = id - compound_min_id;
+        if(i<0 || i>=static_cast<int>(ncompounds))return nullptr;
+        return &compound_records[i];
+    }
+
+    Material make_material(int id){
         if(id>0 && id<ELEMENT_DENSITY_MAXZ){
             return Material(0,id,element_density(id),0.0);
         }
-        return get_compound(static_cast<material>(id));
+        const MaterialRecord *r = find_record(id);
+        if(!r)return Material();
+        Material m;
+        for(std::size_t i=r->first;i<r->first+r->n;i++){
+            m.add_element(compound_components[i].a, compound_components[i].z, compound_components[i].stn);
+        }
+        m.density(r->density);
+        m.calculate();
+        return m;
+    }
+
+    // all predefined materials, index is the material id
+    constexpr int material_max_id = compound_min_id + static_cast<int>(ncompounds);
+    struct InternedMaterials{
+        std::array<Material, material_max_id> materials;
+        InternedMaterials(){
+            for(int id=1;id<material_max_id;id++)materials[id] = make_material(id);
+        }
+    };
+
+    const InternedMaterials& interned(){
+        static const InternedMaterials db;
+        return db;
+    }
+}
+
+    const Material& interned_material(int id){
+        if(id<=0 || id>=material_max_id)return interned().materials[0];
+        return interned().materials[id];
+    }
+
+    Material get_material(int id){
+        return interned_material(id);
         }
 
     Material get_compound(material m){
-      switch(m){
-		 case material::Plastics:	 return Material({{0,1,10},{0,6,9}},1.032);
-		 case material::Air:	 return Material({{0,7,0.755267},{0,8,0.231781},{0,18,0.012827},{0,6,0.000124}},0.001205);
-		 case material::CH2:	 return Material({{0,6,1},{0,1,2}},0.94);
-		 case material::lH2:	 return Material({{0,1,1}},0.0708);
-		 case material::lD2:	 return Material({{2.0141,1,1}},0.162);
-		 case material::Water:	 return Material({{0,1,2},{0,8,1}},1);
-		 case material::Diamond:	 return Material({{0,6,1}},3.52);
-		 case material::Glass:	 return Material({{0,14,0.37722},{0,8,0.539562},{0,5,0.040064},{0,11,0.028191},{0,13,0.011644},{0,19,0.003321}},2.4);
-		 case material::ALMG3:	 return Material({{0,13,0.97},{0,12,0.03}},2.67);
-		 case material::ArCO2_30:	 return Material({{0,18,0.679},{0,8,0.2321},{0,6,0.0889}},0.00171);
-		 case material::CF4:	 return Material({{0,6,1},{0,9,4}},0.00372);
-		 case material::Isobutane:	 return Material({{0,6,4},{0,1,10}},0.00251);
-		 case material::Kapton:	 return Material({{0,1,0.026362},{0,6,0.691133},{0,7,0.07327},{0,8,0.209235}},1.42);
-		 case material::Mylar:	 return Material({{0,6,10},{0,1,8},{0,8,4}},1.38);
-		 case material::NaF:	 return Material({{0,11,1},{0,9,1}},2.56);
-		 case material::P10:	 return Material({{0,18,9},{0,6,1},{0,1,4}},0.00166);
-		 case material::Polyolefin:	 return Material({{0,8,8},{0,1,16}},0.9);
-		 case material::CmO2:	 return Material({{0,96,1},{0,8,2}},12);
-		 case material::Suprasil:	 return Material({{0,14,0.37722},{0,8,0.539562},{0,5,0.040064},{0,11,0.028191},{0,13,0.011644},{0,19,0.003321}},2.2);
-		 case material::HAVAR:	 return Material({{0,27,0.403228},{0,24,0.169412},{0,28,0.124301},{0,74,0.089847},{0,42,0.031259},{0,26,0.181952}},8.3);
-		 case material::Steel:	 return Material({{0,26,0.74621},{0,24,0.169},{0,28,0.08479}},8);
-		 case material::CO2:	 return Material({{0,6,1},{0,8,2}},0.001842);
-		 case material::Methane:	 return Material({{0,1,4},{0,6,1}},0.0006);
-		 case material::Methanol:	 return Material({{0,1,4},{0,6,1},{0,8,1}},0.792);
-		 case material::Acetone:	 return Material({{0,1,6},{0,6,3},{0,8,1}},0.7899);
-		 case material::Acetylene:	 return Material({{0,1,2},{0,6,2}},0.0010967);
-		 case material::Adenine:	 return Material({{0,1,5},{0,6,5},{0,7,5}},1.35);
-		 case material::Adipose_Tissue:	 return Material({{0,1,0.119477},{0,6,0.63724},{0,7,0.00797},{0,8,0.232333},{0,11,0.0005},{0,12,2e-05},{0,15,0.00016},{0,16,0.00073},{0,17,0.00119},{0,19,0.00032},{0,20,2e-05},{0,26,2e-05},{0,30,2e-05}},0.92);
-		 case material::Alanine:	 return Material({{0,1,7},{0,6,3},{0,7,1},{0,8,2}},1.42);
-		 case material::Bakelite:	 return Material({{0,1,0.057441},{0,6,0.774591},{0,8,0.167968}},1.25);
-		 case material::AgBr:	 return Material({{0,47,1},{0,35,1}},6.473);
-		 case material::AgCl:	 return Material({{0,47,1},{0,17,1}},5.56);
-		 case material::AgI:	 return Material({{0,47,1},{0,53,1}},5.675);
-		 case material::Al2O3:	 return Material({{0,8,3},{0,13,2}},3.97);
-		 case material::Amber:	 return Material({{0,1,0.10593},{0,6,0.788974},{0,8,0.105096}},1.1);
-		 case material::Ammonia:	 return Material({{0,1,3},{0,7,1}},0.000826);
-		 case material::Aniline:	 return Material({{0,1,7},{0,6,6},{0,7,1}},1.0235);
-		 case material::Anthracene:	 return Material({{0,1,10},{0,6,14}},1.283);
-		 case material::A_150:	 return Material({{0,1,0.101327},{0,6,0.7755},{0,7,0.035057},{0,8,0.0523159},{0,9,0.017422},{0,20,0.018378}},1.127);
-		 case material::B_100:	 return Material({{0,1,0.0654709},{0,6,0.536944},{0,7,0.0215},{0,8,0.032085},{0,9,0.167411},{0,20,0.176589}},1.45);
-		 case material::BaF2:	 return Material({{0,9,2},{0,56,1}},4.89);
-		 case material::BaSO4:	 return Material({{0,8,4},{0,16,1},{0,56,1}},4.5);
-		 case material::Benzene:	 return Material({{0,1,6},{0,6,6}},0.87865);
-		 case material::BeO:	 return Material({{0,4,1},{0,8,1}},3.01);
-		 case material::BGO:	 return Material({{0,8,12},{0,32,3},{0,83,4}},7.13);
-		 case material::Blood_ICRP:	 return Material({{0,1,0.101866},{0,6,0.10002},{0,7,0.02964},{0,8,0.759414},{0,11,0.00185},{0,12,4e-05},{0,14,3e-05},{0,15,0.00035},{0,16,0.00185},{0,17,0.00278},{0,19,0.00163},{0,20,6e-05},{0,26,0.00046},{0,30,1e-05}},1.06);
-		 case material::Bone_Compact:	 return Material({{0,1,0.063984},{0,6,0.278},{0,7,0.027},{0,8,0.410016},{0,12,0.002},{0,15,0.07},{0,16,0.002},{0,20,0.147}},1.85);
-		 case material::Bone_Cortical:	 return Material({{0,1,0.047234},{0,6,0.14433},{0,7,0.04199},{0,8,0.446096},{0,12,0.0022},{0,15,0.10497},{0,16,0.00315},{0,20,0.20993},{0,30,0.0001}},1.85);
-		 case material::Brain_ICRP:	 return Material({{0,1,0.110667},{0,6,0.12542},{0,7,0.01328},{0,8,0.737723},{0,11,0.00184},{0,12,0.00015},{0,15,0.00354},{0,16,0.00177},{0,17,0.00236},{0,19,0.0031},{0,20,9e-05},{0,26,5e-05},{0,30,1e-05}},1.03);
-		 case material::B4C:	 return Material({{0,5,4},{0,6,1}},2.52);
-		 case material::BC_400:	 return Material({{0,1,10},{0,6,9}},1.032);
-		 case material::nButanol:	 return Material({{0,1,10},{0,6,4},{0,8,1}},0.81);
-		 case material::C_552:	 return Material({{0,1,0.02468},{0,6,0.50161},{0,8,0.004527},{0,9,0.465209},{0,14,0.003973}},1.76);
-		 case material::CdTe:	 return Material({{0,48,1},{0,52,1}},6.2);
-		 case material::CdWO4:	 return Material({{0,8,4},{0,48,1},{0,74,1}},7.9);
-		 case material::CaCO3:	 return Material({{0,6,1},{0,8,3},{0,20,1}},2.8);
-		 case material::CaF2:	 return Material({{0,9,2},{0,20,1}},3.18);
-		 case material::CaO:	 return Material({{0,8,1},{0,20,1}},3.34);
-		 case material::CaWO4:	 return Material({{0,8,4},{0,20,1},{0,74,1}},6.062);
-		 case material::CsF:	 return Material({{0,9,1},{0,55,1}},4.115);
-		 case material::CsI:	 return Material({{0,53,1},{0,55,1}},4.51);
-		 case material::CCl4:	 return Material({{0,6,1},{0,17,4}},1.594);
-		 case material::Tetrachloroethylene:	 return Material({{0,6,2},{0,17,4}},1.622);
-		 case material::Cellophane:	 return Material({{0,1,0.062162},{0,6,0.444462},{0,8,0.493376}},1.42);
-		 case material::Chlorobenzene:	 return Material({{0,1,5},{0,6,6},{0,17,1}},1.1058);
-		 case material::Chloroform:	 return Material({{0,1,1},{0,6,1},{0,17,3}},1.4832);
-		 case material::Cyclohexane:	 return Material({{0,1,12},{0,6,6}},0.779);
-		 case material::Concrete:	 return Material({{0,1,0.01},{0,6,0.001},{0,8,0.529107},{0,11,0.016},{0,12,0.002},{0,13,0.033872},{0,14,0.337021},{0,19,0.013},{0,20,0.044},{0,26,0.014}},2.3);
-		 case material::Diethyl_Ether:	 return Material({{0,1,10},{0,6,4},{0,8,1}},0.71378);
-		 case material::Ethane:	 return Material({{0,1,6},{0,6,2}},0.00125324);
-		 case material::Ethanol:	 return Material({{0,1,6},{0,6,2},{0,8,1}},0.7893);
-		 case material::Ethylene:	 return Material({{0,1,4},{0,6,2}},0.00117497);
-		 case material::Eye_lens:	 return Material({{0,1,0.099269},{0,6,0.19371},{0,7,0.05327},{0,8,0.653751}},1.1);
-		 case material::Fe2O3:	 return Material({{0,8,3},{0,26,2}},5.242);
-		 case material::FeO:	 return Material({{0,8,1},{0,26,1}},5.745);
-		 case material::Freon_12:	 return Material({{0,6,1},{0,9,2},{0,17,2}},1.486);
-		 case material::Freon_12B2:	 return Material({{0,6,1},{0,9,2},{0,35,2}},2.27);
-		 case material::Freon_13:	 return Material({{0,6,1},{0,9,3},{0,17,1}},1.526);
-		 case material::Freon_13B1:	 return Material({{0,6,1},{0,9,3},{0,35,1}},1.538);
-		 case material::Freon_13I1:	 return Material({{0,6,1},{0,9,3},{0,53,1}},1.538);
-		 case material::Gd2O2S:	 return Material({{0,8,2},{0,16,1},{0,64,2}},7.44);
-		 case material::GaAs:	 return Material({{0,31,1},{0,33,1}},5.3176);
-		 case material::Gel_Photo_Emulsion:	 return Material({{0,1,0.08118},{0,6,0.41606},{0,7,0.11124},{0,8,0.38064},{0,16,0.01088}},1.2914);
-		 case material::Glass_Pyrex:	 return Material({{0,5,0.0400639},{0,8,0.539561},{0,11,0.0281909},{0,13,0.011644},{0,14,0.377219},{0,19,0.00332099}},2.23);
-		 case material::Glass_Lead:	 return Material({{0,8,0.156453},{0,14,0.080866},{0,22,0.008092},{0,33,0.002651},{0,82,0.751938}},6.22);
-		 case material::Glucose:	 return Material({{0,1,12},{0,6,6},{0,8,6}},1.54);
-		 case material::Glutamine:	 return Material({{0,1,10},{0,6,5},{0,7,2},{0,8,3}},1.46);
-		 case material::Glycerol:	 return Material({{0,1,8},{0,6,3},{0,8,3}},1.2613);
-		 case material::Guanine:	 return Material({{0,1,5},{0,6,5},{0,7,5},{0,8,1}},1.58);
-		 case material::Gypsum:	 return Material({{0,1,0.023416},{0,8,0.557572},{0,16,0.186215},{0,20,0.232797}},2.32);
-		 case material::nHeptane:	 return Material({{0,1,16},{0,6,7}},0.68376);
-		 case material::nHexane:	 return Material({{0,1,14},{0,6,6}},0.66603);
-		 case material::KI:	 return Material({{0,19,1},{0,53,1}},3.13);
-		 case material::K2O:	 return Material({{0,8,1},{0,19,2}},2.32);
-		 case material::LaBr3:	 return Material({{0,57,1},{0,35,3}},5.06);
-		 case material::LaOBr:	 return Material({{0,8,1},{0,35,1},{0,57,1}},6.28);
-		 case material::La2O2S:	 return Material({{0,8,2},{0,16,1},{0,57,2}},5.86);
-		 case material::Lung:	 return Material({{0,1,0.101278},{0,6,0.10231},{0,7,0.02865},{0,8,0.757072},{0,11,0.00184},{0,12,0.00073},{0,15,0.0008},{0,16,0.00225},{0,17,0.00266},{0,19,0.00194},{0,20,9e-05},{0,26,0.00037},{0,30,1e-05}},1.05);
-		 case material::MgCO3:	 return Material({{0,12,1},{0,6,1},{0,8,3}},2.958);
-		 case material::MgF2:	 return Material({{0,12,1},{0,9,2}},3.148);
-		 case material::MgO:	 return Material({{0,12,1},{0,8,1}},3.6);
-		 case material::MS20_Tissue:	 return Material({{0,1,0.081192},{0,6,0.583442},{0,7,0.017798},{0,8,0.186381},{0,12,0.130287},{0,17,0.0009}},1);
-		 case material::Muscle_skeletal:	 return Material({{0,1,0.100637},{0,6,0.10783},{0,7,0.02768},{0,8,0.754773},{0,11,0.00075},{0,12,0.00019},{0,15,0.0018},{0,16,0.00241},{0,17,0.00079},{0,19,0.00302},{0,20,3e-05},{0,26,4e-05},{0,30,5e-05}},1.04);
-		 case material::Muscle_strained:	 return Material({{0,1,0.101997},{0,6,0.123},{0,7,0.035},{0,8,0.729003},{0,11,0.0008},{0,12,0.0002},{0,15,0.002},{0,16,0.005},{0,19,0.003}},1.04);
-		 case material::Muscle_sucrose:	 return Material({{0,1,0.0982341},{0,6,0.156214},{0,7,0.035451},{0,8,0.710101}},1.11);
-		 case material::Muscle_no_sucrose:	 return Material({{0,1,0.101969},{0,6,0.120058},{0,7,0.035451},{0,8,0.742522}},1.07);
-		 case material::Na2CO3:	 return Material({{0,6,1},{0,8,3},{0,11,1}},2.532);
-		 case material::NaI:	 return Material({{0,11,1},{0,53,1}},3.667);
-		 case material::NaCl:	 return Material({{0,11,1},{0,17,1}},2.165);
-		 case material::Na2O:	 return Material({{0,8,1},{0,11,2}},2.27);
-		 case material::NaNO3:	 return Material({{0,7,1},{0,8,3},{0,11,1}},2.261);
-		 case material::Naphthalene:	 return Material({{0,1,8},{0,6,10}},1.145);
-		 case material::Nitrobenzene:	 return Material({{0,1,5},{0,6,6},{0,7,1},{0,8,2}},1.199);
-		 case material::N2O:	 return Material({{0,7,2},{0,8,1}},0.00183);
-		 case material::Octane:	 return Material({{0,1,18},{0,6,8}},0.703);
-		 case material::Paraffin:	 return Material({{0,1,0.148605},{0,6,0.851395}},0.93);
-		 case material::nPentane:	 return Material({{0,1,12},{0,6,5}},0.626);
-		 case material::PhotoEmulsion:	 return Material({{0,1,0.0141},{0,6,0.072261},{0,7,0.01932},{0,8,0.066101},{0,16,0.00189},{0,35,0.349103},{0,47,0.474105}},3.815);
-		 case material::PuO2:	 return Material({{0,8,2},{0,94,1}},11.46);
-		 case material::Polyacrylonitrile:	 return Material({{0,1,3},{0,6,3},{0,7,1}},1.184);
-		 case material::Polycarbonate:	 return Material({{0,1,0.055491},{0,6,0.755751},{0,8,0.188758}},1.2);
-		 case material::PMMA:	 return Material({{0,1,8},{0,6,5},{0,8,2}},1.18);
-		 case material::POM:	 return Material({{0,1,2},{0,6,1},{0,8,1}},1.42);
-		 case material::Polypropylene:	 return Material({{0,6,3},{0,1,6}},0.9);
-		 case material::Polystyrene:	 return Material({{0,6,8},{0,1,8}},1.06);
-		 case material::Propane:	 return Material({{0,1,8},{0,6,3}},0.00188);
-		 case material::nPropanol:	 return Material({{0,1,8},{0,6,3},{0,8,1}},0.8035);
-		 case material::PVC:	 return Material({{0,1,3},{0,6,2},{0,17,1}},1.3);
-		 case material::Pyridine:	 return Material({{0,1,5},{0,6,5},{0,7,1}},0.9819);
-		 case material::SiO2:	 return Material({{0,8,2},{0,14,1}},2.32);
-		 case material::Skin:	 return Material({{0,1,0.100588},{0,6,0.22825},{0,7,0.04642},{0,8,0.619002},{0,11,7e-05},{0,12,6e-05},{0,15,0.00033},{0,16,0.00159},{0,17,0.00267},{0,19,0.00085},{0,20,0.00015},{0,26,1e-05},{0,30,1e-05}},1.1);
-		 case material::Sucrose:	 return Material({{0,1,22},{0,6,12},{0,8,11}},1.587);
-		 case material::Teflon:	 return Material({{0,6,2},{0,9,4}},2.2);
-		 case material::TlCl:	 return Material({{0,17,1},{0,81,1}},7.004);
-		 case material::Toluene:	 return Material({{0,1,8},{0,6,7}},0.8669);
-		 case material::Trichloroethylene:	 return Material({{0,1,1},{0,6,2},{0,17,3}},1.46);
-		 case material::WF6:	 return Material({{0,9,6},{0,74,1}},2.4);
-		 case material::UC2:	 return Material({{0,6,2},{0,92,1}},11.28);
-		 case material::UC:	 return Material({{0,6,1},{0,92,1}},13.63);
-		 case material::UO2:	 return Material({{0,8,2},{0,92,1}},10.97);
-		 case material::Urea:	 return Material({{0,1,0.067131},{0,6,0.2},{0,7,0.466459},{0,8,0.266411}},1.323);
-		 case material::Valine:	 return Material({{0,1,11},{0,6,5},{0,7,1},{0,8,2}},1.23);
-		 case material::Iodonaphthalene:	 return Material({{0,6,10},{0,1,7},{0,53,1}},1.738);
-		 case material::C21H24O4:	 return Material({{0,6,21},{0,1,24},{0,8,4}},1.18);
-		 case material::CoRe_Alloy:	 return Material({{0,27,17},{0,75,23},{0,24,1}},11.5);
-		 case material::LLZO_electrolyte:	 return Material({{0,3,7},{0,57,3},{0,40,2},{0,8,12}},5.1);
-		 case material::Nylon:	 return Material({{0,6,6},{0,1,11},{0,7,1},{0,8,1}},1.14);
-            default:break;
-             }
-        return Material();
+        if(!find_record(static_cast<int>(m)))return Material();
+        return interned_material(static_cast<int>(m));
+    }
+
+    int material_id(const char *name){
+        if(!name)return 0;
+        const std::size_t b = name_hash(name, 0)%name_hash_buckets;
+        const std::size_t s = name_hash(name, name_hash_table.displacement[b])%name_hash_slots;
+        const int i = name_hash_table.index[s];
+        if(i<0 || std::strcmp(compound_records[i].name, name)!=0)return 0;
+        return static_cast<int>(compound_records[i].id);
+    }
+
+    const char* material_name(material m){
+        const MaterialRecord *r = find_record(static_cast<int>(m));
+        return r?r->name:"";
+    }
+
+    const MaterialRecord* material_record(material m){
+        return find_record(static_cast<int>(m));
     }
 
 }  // namespace catima
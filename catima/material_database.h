@@ -1,5 +1,6 @@
 #ifndef MATERIAL_DATABASE
 #define MATERIAL_DATABASE
+#include <cstddef>
 #include "catima/catima.h"
 
 namespace catima{
@@ -154,12 +155,63 @@ namespace catima{
 		 Nylon = 347
         };
 
+      /**
+        * component of the predefined compound
+        * a - mass number, 0 means the elemental atomic weight
+        * z - proton number
+        * stn - stoichiometric number or weight fraction
+        */
+      struct MaterialComponent{
+            double a;
+            int z;
+            double stn;
+      };
+
+      /**
+        * record of the predefined compound in the static material table
+        * components are compound_components[first .. first+n)
+        */
+      struct MaterialRecord{
+            material id;
+            const char *name;
+            double density;
+            std::size_t first;
+            std::size_t n;
+      };
+
       Material get_compound(material m);
       Material get_material(int id);
       inline Material get_material(material m){
             return get_compound(m);
       };
 
+      /**
+        * returns reference to the interned predefined material
+        * the materials are constructed once on the first call, the reference stays valid
+        * for the lifetime of the program, unknown id returns empty Material
+        * @param id - proton number for elements or material enum value for compounds
+        */
+      const Material& interned_material(int id);
+      inline const Material& interned_material(material m){
+            return interned_material(static_cast<int>(m));
+      };
+
+      /**
+        * returns id of the predefined compound from its name, ie "Water"
+        * @return material id or 0 if the name is not known
+        */
+      int material_id(const char *name);
+
+      /**
+        * @return name of the predefined compound or empty string
+        */
+      const char* material_name(material m);
+
+      /**
+        * @return pointer to the static record of the compound or nullptr
+        */
+      const MaterialRecord* material_record(material m);
+
 }
 
 #endif
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include "catima/montecarlo.h"
+
+namespace catima{
+
+namespace{
+    constexpr std::uint32_t source_domain = 0;
+    constexpr std::uint32_t transport_domain = 1;
+    constexpr std::size_t histogram_chunk = 1<<16;
+
+    // correlated Gaussian pair with variances sa2, sx2 and covariance c
+    inline void sample_correlated(RandomStream &rng, double sa2, double sx2, double c, double &a, double &x){
+        const double n1 = rng.normal();
+        const double n2 = rng.normal();
+        if(sa2<=0.0){
+            a = 0.0;
+            x = std::sqrt(std::max(sx2, 0.0))*n2;
+            return;
+        }
+        const double sa = std::sqrt(sa2);
+        a = sa*n1;
+        x = (c/sa)*n1 + std::sqrt(std::max(sx2 - c*c/sa2, 0.0))*n2;
+    }
+
+    inline double get_variable(const ParticleBatch &b, std::size_t i, mc_variable v){
+        switch(v){
+            case mc_variable::x: return b.x[i];
+            case mc_variable::ax: return b.ax[i];
+            case mc_variable::y: return b.y[i];
+            case mc_variable::ay: return b.ay[i];
+            default: return b.T[i];
+        }
+    }
+
+    void fill_particles(const Beam &beam, ParticleBatch &b, std::size_t first_id, std::uint64_t seed, ThreadPool &pool){
+        pool.parallel_for(b.size(), [&](std::size_t i){
+            RandomStream rng(seed, first_id+i, source_domain);
+            b.T[i] = std::max(beam.T + beam.sigma_T*rng.normal(), 0.0);
+            sample_correlated(rng, beam.x.sigma_a*beam.x.sigma_a, beam.x.sigma_x*beam.x.sigma_x, beam.x.cov_x, b.ax[i], b.x[i]);
+            sample_correlated(rng, beam.y.sigma_a*beam.y.sigma_a, beam.y.sigma_x*beam.y.sigma_x, beam.y.cov_x, b.ay[i], b.y[i]);
+            b.alive[i] = (b.T[i]>=Ezero)?1:0;
+            }, 1024);
+    }
+}
+
+void ParticleBatch::resize(std::size_t n){
+    T.resize(n);
+    x.resize(n);
+    ax.resize(n);
+    y.resize(n);
+    ay.resize(n);
+    alive.resize(n);
+}
+
+std::size_t ParticleBatch::count_alive() const{
+    return std::count(alive.begin(), alive.end(), 1);
+}
+
+Histogram::Histogram(int nbins, double _min, double _max):min(_min), max(_max), counts(std::max(nbins,1), 0.0){}
+
+void Histogram::fill(double v, double weight){
+    if(v<min){
+        underflow += weight;
+        return;
+    }
+    if(v>=max){
+        overflow += weight;
+        return;
+    }
+    int i = static_cast<int>((v-min)/(max-min)*counts.size());
+    counts[std::min(i, nbins()-1)] += weight;
+}
+
+void Histogram::add(const Histogram &h){
+    for(std::size_t i=0;i<counts.size() && i<h.counts.size();i++){
+        counts[i] += h.counts[i];
+    }
+    underflow += h.underflow;
+    overflow += h.overflow;
+}
+
+double Histogram::integral() const{
+    double sum = 0.0;
+    for(double v:counts)sum += v;
+    return sum;
+}
+
+ParticleBatch generate_particles(const Beam &beam, std::size_t n, std::uint64_t seed, std::size_t first_id, ThreadPool &pool){
+    ParticleBatch b;
+    b.resize(n);
+    fill_particles(beam, b, first_id, seed, pool);
+    return b;
+}
+
+MonteCarloTransport::MonteCarloTransport(const Projectile &_p, const Layers &_layers, const Config &c, double emax)
+    :p(_p), layers(_layers){
+    tables.reserve(layers.num());
+    for(const Material &m:layers.get_materials()){
+        Layers l;
+        l.add(m);
+        tables.emplace_back(p, l, c, emax);
+    }
+}
+
+void MonteCarloTransport::transport_particle(ParticleBatch &b, std::size_t i, RandomStream &rng) const{
+    for(std::size_t k=0;k<tables.size();k++){
+        if(!b.alive[i])return;
+        const double L = layers.get_materials()[k].thickness_cm();
+        Result r = tables[k](b.T[i]);
+        if(r.Eout<Ezero){
+            b.T[i] = 0.0;
+            b.alive[i] = 0;
+            return;
+        }
+        #ifdef REACTIONS
+        if(sample_reactions && r.sp>=0.0 && rng.uniform()>r.sp){
+            b.alive[i] = 0;
+            return;
+        }
+        #endif
+        b.T[i] = r.Eout + r.sigma_E*rng.normal();
+        double da, dx;
+        sample_correlated(rng, r.sigma_a*r.sigma_a, r.sigma_x*r.sigma_x, r.cov, da, dx);
+        b.x[i] += L*b.ax[i] + dx;
+        b.ax[i] += da;
+        sample_correlated(rng, r.sigma_a*r.sigma_a, r.sigma_x*r.sigma_x, r.cov, da, dx);
+        b.y[i] += L*b.ay[i] + dx;
+        b.ay[i] += da;
+        if(b.T[i]<Ezero){
+            b.T[i] = 0.0;
+            b.alive[i] = 0;
+        }
+    }
+}
+
+void MonteCarloTransport::transport(ParticleBatch &particles, std::uint64_t seed, std::size_t first_id, ThreadPool &pool) const{
+    pool.parallel_for(particles.size(), [&](std::size_t i){
+        RandomStream rng(seed, first_id+i, transport_domain);
+        transport_particle(particles, i, rng);
+        }, 1024);
+}
+
+Histogram MonteCarloTransport::histogram(const Beam &beam, std::size_t n, std::uint64_t seed, mc_variable v,
+                                         int nbins, double min, double max, ThreadPool &pool) const{
+    const std::size_t nchunks = (n+histogram_chunk-1)/histogram_chunk;
+    std::vector<Histogram> h(nchunks, Histogram(nbins, min, max));
+    pool.parallel_for(nchunks, [&](std::size_t ichunk){
+        const std::size_t first = ichunk*histogram_chunk;
+        ParticleBatch b;
+        b.resize(std::min(histogram_chunk, n-first));
+        fill_particles(beam, b, first, seed, pool);
+        for(std::size_t i=0;i<b.size();i++){
+            RandomStream rng(seed, first+i, transport_domain);
+            transport_particle(b, i, rng);
+            if(b.alive[i])h[ichunk].fill(get_variable(b, i, v));
+        }
+        }, 1);
+
+    // merged in fixed order so the sums do not depend on threads
+    Histogram res(nbins, min, max);
+    for(const auto &hc:h)res.add(hc);
+    return res;
+}
+
+}
@@ -0,0 +1,220 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_MONTECARLO_H
+#define CATIMA_MONTECARLO_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "catima/constants.h"
+#include "catima/structures.h"
+#include "catima/config.h"
+#include "catima/layers_table.h"
+#include "catima/thread_pool.h"
+
+namespace catima{
+
+/**
+ * Philox4x32-10 counter-based random number generator
+ * the output is a function of counter and key only, so independent streams
+ * are obtained just by using different counters
+ */
+struct Philox4x32{
+    using counter_type = std::array<std::uint32_t, 4>;
+    using key_type = std::array<std::uint32_t, 2>;
+
+    static counter_type generate(counter_type ctr, key_type key){
+        for(int i=0;i<10;i++){
+            round(ctr, key);
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        return ctr;
+    }
+
+private:
+    static void round(counter_type &ctr, const key_type &key){
+        const std::uint64_t p0 = std::uint64_t(0xD2511F53u)*ctr[0];
+        const std::uint64_t p1 = std::uint64_t(0xCD9E8D57u)*ctr[2];
+        const std::uint32_t hi0 = static_cast<std::uint32_t>(p0>>32);
+        const std::uint32_t lo0 = static_cast<std::uint32_t>(p0);
+        const std::uint32_t hi1 = static_cast<std::uint32_t>(p1>>32);
+        const std::uint32_t lo1 = static_cast<std::uint32_t>(p1);
+        ctr = {hi1^ctr[1]^key[0], lo1, hi0^ctr[3]^key[1], lo0};
+    }
+};
+
+/**
+ * stream of random numbers identified by seed, stream number and domain
+ * the same combination always gives the same sequence
+ */
+class RandomStream{
+public:
+    RandomStream(std::uint64_t seed, std::uint64_t stream, std::uint32_t domain=0)
+        :key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed>>32)},
+         stream_lo(static_cast<std::uint32_t>(stream)), stream_hi(static_cast<std::uint32_t>(stream>>32)), domain(domain){}
+
+    /// uniform random number in (0,1)
+    double uniform(){
+        if(nbuffer==0)refill();
+        nbuffer--;
+        return buffer[nbuffer];
+    }
+
+    /// normal distributed random number with mean 0 and sigma 1
+    double normal(){
+        if(has_normal){
+            has_normal = false;
+            return normal_cache;
+        }
+        const double r = std::sqrt(-2.0*std::log(uniform()));
+        const double phi = 2.0*PI*uniform();
+        normal_cache = r*std::sin(phi);
+        has_normal = true;
+        return r*std::cos(phi);
+    }
+
+private:
+    void refill(){
+        auto r = Philox4x32::generate({counter, domain, stream_lo, stream_hi}, key);
+        counter++;
+        // 53 bits per number, shifted by half step to exclude 0
+        constexpr double norm = 1.0/9007199254740992.0;
+        buffer[0] = ((double)((std::uint64_t(r[0])<<21) ^ (r[1]>>11)) + 0.5)*norm;
+        buffer[1] = ((double)((std::uint64_t(r[2])<<21) ^ (r[3]>>11)) + 0.5)*norm;
+        nbuffer = 2;
+    }
+
+    Philox4x32::key_type key;
+    std::uint32_t stream_lo, stream_hi, domain;
+    std::uint32_t counter = 0;
+    std::array<double,2> buffer;
+    int nbuffer = 0;
+    double normal_cache = 0.0;
+    bool has_normal = false;
+};
+
+/**
+ * particles stored as structure of arrays
+ * x,y in cm, ax,ay in rad, T in MeV/u
+ */
+struct ParticleBatch{
+    std::vector<double> T;
+    std::vector<double> x;
+    std::vector<double> ax;
+    std::vector<double> y;
+    std::vector<double> ay;
+    std::vector<unsigned char> alive;
+
+    std::size_t size() const {return T.size();}
+    void resize(std::size_t n);
+    /// number of particles not stopped and not lost in reactions
+    std::size_t count_alive() const;
+};
+
+/**
+ * initial beam distribution, Gaussian in energy and in both transverse planes
+ */
+struct Beam{
+    double T = 0.0;
+    double sigma_T = 0.0;
+    Phasespace x;
+    Phasespace y;
+};
+
+enum class mc_variable{T=0, x, ax, y, ay};
+
+/**
+ * 1D histogram with equidistant bins
+ */
+struct Histogram{
+    Histogram(int nbins, double min, double max);
+    void fill(double v, double weight=1.0);
+    void add(const Histogram &h);
+    int nbins() const {return static_cast<int>(counts.size());}
+    double bin_center(int i) const {return min + (i+0.5)*(max-min)/counts.size();}
+    double integral() const;
+
+    double min;
+    double max;
+    std::vector<double> counts;
+    double underflow = 0.0;
+    double overflow = 0.0;
+};
+
+/**
+ * samples n particles from the Beam
+ * i-th particle gets random stream first_id+i, so the result does not depend on the number of threads
+ */
+ParticleBatch generate_particles(const Beam &beam, std::size_t n, std::uint64_t seed, std::size_t first_id=0, ThreadPool &pool=default_thread_pool());
+
+/**
+ * @brief event by event transport of particles through Layers
+ * The energy loss, angular and position straggling in every layer are sampled from Gaussian distributions
+ * with widths taken from the precalculated LayersTable of the layer, the angle and position
+ * are sampled with their correlation. The reaction losses are sampled from survival probability.
+ * Every particle uses its own random stream, so the results are reproducible for given seed
+ * independently of the number of threads.
+ *
+ * Example usage:
+ * \code{.cpp}
+ * MonteCarloTransport mc(p, layers);
+ * auto particles = generate_particles(beam, 1000000, seed);
+ * mc.transport(particles, seed);
+ * \endcode
+ */
+class MonteCarloTransport{
+public:
+    /**
+     * @param p - Projectile
+     * @param layers - Layers
+     * @param c - Config
+     * @param emax - maximum tabulated energy in MeV/u
+     */
+    MonteCarloTransport(const Projectile &p, const Layers &layers, const Config &c=default_config, double emax=1e4);
+
+    /// enable or disable sampling of nuclear reaction losses, enabled by default
+    void set_reactions(bool v){sample_reactions = v;}
+
+    /**
+     * transports particles through all layers, the batch is updated in place
+     * @param particles - particles to transport
+     * @param seed - random seed
+     * @param first_id - id of the first particle, used to select random streams
+     */
+    void transport(ParticleBatch &particles, std::uint64_t seed, std::size_t first_id=0, ThreadPool &pool=default_thread_pool()) const;
+
+    /**
+     * generates and transports n particles in chunks and fills histogram of variable v of surviving particles
+     * the particles are not stored so the memory usage does not depend on n
+     */
+    Histogram histogram(const Beam &beam, std::size_t n, std::uint64_t seed, mc_variable v,
+                        int nbins, double min, double max, ThreadPool &pool=default_thread_pool()) const;
+
+    const Layers& get_layers() const {return layers;}
+
+private:
+    void transport_particle(ParticleBatch &particles, std::size_t i, RandomStream &rng) const;
+
+    Projectile p;
+    Layers layers;
+    std::vector<LayersTable> tables;
+    bool sample_reactions = true;
+};
+
+}
+#endif
@@ -0,0 +1,114 @@
+#include <memory>
+#include "catima/phasespace.h"
+#include "catima/catima.h"
+#include "catima/storage.h"
+
+namespace catima{
+
+using namespace ps_index;
+
+namespace{
+    TransportMap<6> layer_map(const DataPoint &data, double T, const Material &m){
+        TransportMap<6> map;
+        map.Ein = T;
+        map.Eout = T;
+        const double L = m.thickness_cm();
+        map.R(x,a) = L;
+        map.R(y,b) = L;
+        if(m.thickness()<=0.0)return map;
+
+        Result r = calculate(data, T, m);
+        map.Eout = r.Eout;
+        if(r.Eout<Ezero){
+            map.stopped = true;
+            map.R(d,d) = 0.0;
+            return map;
+        }
+        map.Q(x,x) = r.sigma_x*r.sigma_x;
+        map.Q(x,a) = map.Q(a,x) = r.cov;
+        map.Q(a,a) = r.sigma_a*r.sigma_a;
+        map.Q(y,y) = map.Q(x,x);
+        map.Q(y,b) = map.Q(b,y) = map.Q(x,a);
+        map.Q(b,b) = map.Q(a,a);
+        map.Q(d,d) = (r.sigma_E/r.Eout)*(r.sigma_E/r.Eout);
+
+        // energy magnification and TOF dependence on the incoming energy
+        const double Tm = 0.99*T;
+        const double Tp = 1.01*T;
+        spline_type range_spline = get_range_spline(data);
+        const double em = energy_out(Tm, m.thickness(), range_spline);
+        const double ep = energy_out(Tp, m.thickness(), range_spline);
+        if(em>0.0 && ep>0.0){
+            Projectile p = data.p;
+            map.R(d,d) = T*(ep-em)/(r.Eout*(Tp-Tm));
+            map.R(t,d) = T*(calculate_tof_from_E(p(Tp), ep, m, data.config) - calculate_tof_from_E(p(Tm), em, m, data.config))/(Tp-Tm);
+        }
+        else{
+            map.R(d,d) = 0.0;
+        }
+        return map;
+    }
+
+    TransportMap<6> layers_map(const std::vector<std::shared_ptr<const DataPoint>> &data, double T, const Layers &layers){
+        TransportMap<6> map;
+        map.Ein = T;
+        map.Eout = T;
+        for(int i=0;i<layers.num();i++){
+            map = map.then(layer_map(*data[i], map.Eout, layers.get_materials()[i]));
+            if(map.stopped){
+                map.Eout = 0.0;
+                break;
+            }
+        }
+        return map;
+    }
+
+    std::vector<std::shared_ptr<const DataPoint>> layers_data(const Projectile &p, const Layers &layers, const Config &c){
+        std::vector<std::shared_ptr<const DataPoint>> data;
+        data.reserve(layers.num());
+        for(const Material &m:layers.get_materials()){
+            data.push_back(_shared_storage.Get(p, m, c));
+        }
+        return data;
+    }
+}
+
+SigmaMatrix2 sigma_matrix(const Phasespace &ps){
+    SigmaMatrix2 s;
+    s(x,x) = ps.sigma_x*ps.sigma_x;
+    s(x,a) = s(a,x) = ps.cov_x;
+    s(a,a) = ps.sigma_a*ps.sigma_a;
+    return s;
+}
+
+SigmaMatrix4 sigma_matrix(const Phasespace &psx, const Phasespace &psy){
+    SigmaMatrix4 s;
+    s(x,x) = psx.sigma_x*psx.sigma_x;
+    s(x,a) = s(a,x) = psx.cov_x;
+    s(a,a) = psx.sigma_a*psx.sigma_a;
+    s(y,y) = psy.sigma_x*psy.sigma_x;
+    s(y,b) = s(b,y) = psy.cov_x;
+    s(b,b) = psy.sigma_a*psy.sigma_a;
+    return s;
+}
+
+TransportMap<6> transport_map(const Projectile &p, const Material &m, const Config &c){
+    auto data = _shared_storage.Get(p, m, c);
+    return layer_map(*data, p.T, m);
+}
+
+TransportMap<6> transport_map(const Projectile &p, const Layers &layers, const Config &c){
+    return layers_map(layers_data(p, layers, c), p.T, layers);
+}
+
+std::vector<TransportMap<6>> transport_map(const Projectile &p, const std::vector<double> &energies, const Layers &layers,
+                                           const Config &c, ThreadPool &pool){
+    auto data = layers_data(p, layers, c);
+    std::vector<TransportMap<6>> res(energies.size());
+    pool.parallel_for(energies.size(), [&](std::size_t i){
+        res[i] = layers_map(data, energies[i], layers);
+        });
+    return res;
+}
+
+}
@@ -0,0 +1,225 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_PHASESPACE_H
+#define CATIMA_PHASESPACE_H
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include "catima/structures.h"
+#include "catima/config.h"
+#include "catima/thread_pool.h"
+
+namespace catima{
+
+/**
+ * indices of the phase space coordinates
+ * x,y - position in cm, a,b - angle in rad, t - time in ns, d - relative energy deviation dT/T
+ */
+namespace ps_index{
+    constexpr int x = 0;
+    constexpr int a = 1;
+    constexpr int y = 2;
+    constexpr int b = 3;
+    constexpr int t = 4;
+    constexpr int d = 5;
+}
+
+/**
+ * fixed size square matrix, stored row by row
+ */
+template<int N>
+struct Matrix{
+    std::array<double, N*N> m{};
+
+    double& operator()(int i, int j){return m[i*N+j];}
+    double operator()(int i, int j) const {return m[i*N+j];}
+    static constexpr int size(){return N;}
+
+    static Matrix identity(){
+        Matrix r;
+        for(int i=0;i<N;i++)r(i,i) = 1.0;
+        return r;
+    }
+
+    Matrix transpose() const{
+        Matrix r;
+        for(int i=0;i<N;i++)
+            for(int j=0;j<N;j++)r(j,i) = (*this)(i,j);
+        return r;
+    }
+
+    /// leading K x K block
+    template<int K>
+    Matrix<K> block() const{
+        static_assert(K<=N, "block must be smaller than matrix");
+        Matrix<K> r;
+        for(int i=0;i<K;i++)
+            for(int j=0;j<K;j++)r(i,j) = (*this)(i,j);
+        return r;
+    }
+
+    Matrix& operator+=(const Matrix &o){
+        for(int i=0;i<N*N;i++)m[i] += o.m[i];
+        return *this;
+    }
+};
+
+template<int N>
+Matrix<N> operator+(Matrix<N> a, const Matrix<N> &b){
+    return a += b;
+}
+
+template<int N>
+Matrix<N> operator*(const Matrix<N> &a, const Matrix<N> &b){
+    Matrix<N> r;
+    for(int i=0;i<N;i++)
+        for(int k=0;k<N;k++){
+            const double v = a(i,k);
+            if(v==0.0)continue;
+            for(int j=0;j<N;j++)r(i,j) += v*b(k,j);
+        }
+    return r;
+}
+
+template<int N>
+bool operator==(const Matrix<N> &a, const Matrix<N> &b){
+    return a.m == b.m;
+}
+
+using SigmaMatrix2 = Matrix<2>;  // (x, a)
+using SigmaMatrix4 = Matrix<4>;  // (x, a, y, b)
+using SigmaMatrix6 = Matrix<6>;  // (x, a, y, b, t, d)
+
+/**
+ * linear transport of the beam sigma matrix through material
+ * sigma_out = R * sigma_in * R^T + Q
+ * R is transfer matrix of the central particle, Q is the variance added by straggling
+ */
+template<int N>
+struct TransportMap{
+    Matrix<N> R = Matrix<N>::identity();
+    Matrix<N> Q;
+    double Ein = 0.0;
+    double Eout = 0.0;
+    bool stopped = false;
+
+    /// returns transported sigma matrix
+    Matrix<N> operator()(const Matrix<N> &sigma) const{
+        return R*sigma*R.transpose() + Q;
+    }
+
+    /// map of this map followed by map next
+    TransportMap then(const TransportMap &next) const{
+        TransportMap r;
+        r.R = next.R*R;
+        r.Q = next.R*Q*next.R.transpose() + next.Q;
+        r.Ein = Ein;
+        r.Eout = next.Eout;
+        r.stopped = stopped || next.stopped;
+        return r;
+    }
+
+    /// map reduced to leading K coordinates
+    template<int K>
+    TransportMap<K> reduce() const{
+        TransportMap<K> r;
+        r.R = R.template block<K>();
+        r.Q = Q.template block<K>();
+        r.Ein = Ein;
+        r.Eout = Eout;
+        r.stopped = stopped;
+        return r;
+    }
+};
+
+/// 2x2 sigma matrix from Phasespace
+SigmaMatrix2 sigma_matrix(const Phasespace &ps);
+
+/// 4x4 sigma matrix from Phasespaces of x and y plane
+SigmaMatrix4 sigma_matrix(const Phasespace &psx, const Phasespace &psy);
+
+/**
+ * Phasespace of one plane from sigma matrix
+ * @param plane - 0 for x plane, 1 for y plane
+ */
+template<int N>
+Phasespace to_phasespace(const Matrix<N> &sigma, int plane=0){
+    const int i = 2*plane;
+    Phasespace ps;
+    ps.sigma_x = std::sqrt(std::abs(sigma(i, i)));
+    ps.sigma_a = std::sqrt(std::abs(sigma(i+1, i+1)));
+    ps.cov_x = sigma(i, i+1);
+    return ps;
+}
+
+/**
+ * calculates transport map of the material for the projectile with energy p.T
+ * the dispersion (energy magnification) and time-energy correlation are calculated
+ * from the energies and TOF at +-1% of the incoming energy
+ */
+TransportMap<6> transport_map(const Projectile &p, const Material &m, const Config &c=default_config);
+
+/**
+ * calculates transport map of all Layers for the projectile with energy p.T
+ */
+TransportMap<6> transport_map(const Projectile &p, const Layers &layers, const Config &c=default_config);
+
+/**
+ * transports sigma matrix through the Layers
+ * @param p - Projectile with central energy
+ * @param sigma - initial sigma matrix
+ * @return final sigma matrix
+ */
+template<int N>
+Matrix<N> transport(const Projectile &p, const Matrix<N> &sigma, const Layers &layers, const Config &c=default_config){
+    return transport_map(p, layers, c).template reduce<N>()(sigma);
+}
+
+/**
+ * transports multiple sigma matrices through the same map
+ */
+template<int N>
+std::vector<Matrix<N>> transport(const TransportMap<N> &map, const std::vector<Matrix<N>> &sigmas, ThreadPool &pool=default_thread_pool()){
+    std::vector<Matrix<N>> res(sigmas.size());
+    pool.parallel_for(sigmas.size(), [&](std::size_t i){
+        res[i] = map(sigmas[i]);
+        });
+    return res;
+}
+
+/**
+ * calculates transport maps of the Layers for multiple central energies in parallel
+ */
+std::vector<TransportMap<6>> transport_map(const Projectile &p, const std::vector<double> &energies, const Layers &layers,
+                                           const Config &c=default_config, ThreadPool &pool=default_thread_pool());
+
+/**
+ * transports multiple beam envelopes, i-th sigma matrix is transported with i-th central energy
+ */
+template<int N>
+std::vector<Matrix<N>> transport(const Projectile &p, const std::vector<double> &energies, const std::vector<Matrix<N>> &sigmas,
+                                 const Layers &layers, const Config &c=default_config, ThreadPool &pool=default_thread_pool()){
+    auto maps = transport_map(p, energies, layers, c, pool);
+    std::vector<Matrix<N>> res(sigmas.size());
+    pool.parallel_for(std::min(sigmas.size(), maps.size()), [&](std::size_t i){
+        res[i] = maps[i].template reduce<N>()(sigmas[i]);
+        });
+    return res;
+}
+
+}
+#endif
@@ -16,6 +16,13 @@ using catima::SigmaR_Kox;
 namespace catima{
     
 double nonreaction_rate(Projectile &projectile, const Material &target, const Config &c){
+    if(projectile.T<emin_reaction)return -1.0;
+    if(target.thickness()<=0.0)return 1.0;
+    auto& data = _storage.Get(projectile,target,c);
+    return nonreaction_rate(projectile, target, data);
+    }
+
+double nonreaction_rate(const Projectile &projectile, const Material &target, const DataPoint &data){
 
     if(projectile.T<emin_reaction)return -1.0;
     if(target.thickness()<=0.0)return 1.0;
@@ -23,7 +30,6 @@ double nonreaction_rate(Projectile &projectile, const Material &target, const Co
     int ap = lround(projectile.A);
     int zp = lround(projectile.Z);
 
-    auto& data = _storage.Get(projectile,target,c);
     spline_type range_spline = get_range_spline(data);
     if(energy_out(projectile.T, target.thickness(), range_spline) < emin_reaction)return -1.0;
     
@@ -20,6 +20,7 @@
 #include "catima/structures.h"
 #include "catima/config.h"
 #include "catima/integrator.h"
+#include "catima/storage.h"
 #include <cmath>
 
 namespace catima{
@@ -49,6 +50,11 @@ namespace catima{
         return 1.0 - std::exp(-i*0.0001);
     }
     double nonreaction_rate(Projectile &projectile, const Material &target, const Config &c=default_config);
+
+    /**
+     * return nonreaction rate using range spline from precalculated DataPoint
+     */
+    double nonreaction_rate(const Projectile &projectile, const Material &target, const DataPoint &data);
     double production_rate(double cs, double rcs_projectile, double rcs_product, const Material &target, const Config &c=default_config);
     
 #ifndef NUREX
@@ -0,0 +1,128 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_SMALL_VECTOR_H
+#define CATIMA_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace catima{
+
+/**
+ * vector with inline storage for up to N elements
+ * the elements are stored on the heap only if there is more than N of them,
+ * so copies of small vectors do not allocate
+ * only trivially copyable types are supported
+ */
+template<typename T, std::size_t N>
+class small_vector{
+    static_assert(std::is_trivially_copyable<T>::value, "small_vector requires trivially copyable type");
+    public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() = default;
+    small_vector(const small_vector &o){assign(o.begin(), o.size());}
+    small_vector(small_vector &&o) noexcept {move_from(o);}
+    small_vector& operator=(const small_vector &o){
+        if(this!=&o){
+            n = 0;
+            assign(o.begin(), o.size());
+        }
+        return *this;
+    }
+    small_vector& operator=(small_vector &&o) noexcept {
+        if(this!=&o){
+            release();
+            move_from(o);
+        }
+        return *this;
+    }
+    ~small_vector(){release();}
+
+    T* data(){return heap?heap:buf.data();}
+    const T* data() const {return heap?heap:buf.data();}
+    T& operator[](size_type i){return data()[i];}
+    const T& operator[](size_type i) const {return data()[i];}
+    iterator begin(){return data();}
+    iterator end(){return data()+n;}
+    const_iterator begin() const {return data();}
+    const_iterator end() const {return data()+n;}
+    size_type size() const {return n;}
+    size_type capacity() const {return heap?cap:N;}
+    bool empty() const {return n==0;}
+
+    /// true if the elements are stored inline
+    bool is_inline() const {return heap==nullptr;}
+
+    void reserve(size_type c){
+        if(c<=capacity())return;
+        T *p = new T[c];
+        std::copy(begin(), end(), p);
+        delete[] heap;
+        heap = p;
+        cap = c;
+    }
+
+    void push_back(const T &v){
+        if(n==capacity())reserve(2*capacity());
+        data()[n++] = v;
+    }
+
+    void clear(){n = 0;}
+
+    private:
+    void assign(const T *p, size_type count){
+        reserve(count);
+        std::copy(p, p+count, data());
+        n = count;
+    }
+    void move_from(small_vector &o){
+        if(o.heap){
+            heap = o.heap;
+            cap = o.cap;
+            n = o.n;
+            o.heap = nullptr;
+            o.cap = 0;
+            o.n = 0;
+        }
+        else{
+            heap = nullptr;
+            cap = 0;
+            std::copy(o.begin(), o.end(), buf.data());
+            n = o.n;
+        }
+    }
+    void release(){
+        delete[] heap;
+        heap = nullptr;
+        cap = 0;
+        n = 0;
+    }
+
+    std::array<T, N> buf;
+    T *heap = nullptr;
+    size_type n = 0;
+    size_type cap = 0;
+};
+
+}
+
+#endif
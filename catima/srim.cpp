@@ -1,6 +1,8 @@
 #include "srim.h"
 #include <cmath>
 #include <algorithm>
+#include "catima/constants.h"
+#include "catima/lazy_tables.h"
 namespace catima{
 /**
   * return SRIM proton stopping power
@@ -158,6 +160,20 @@ double srim_dedx_e(int pZ, int tZ, double energy, bool use_new){
     }
 };
 
+namespace{
+    constexpr int srim_table_maxz = 92;
+    const LazyLogTables& srim_tables(){
+        static const LazyLogTables tables(2*srim_table_maxz*srim_table_maxz, srim_table_logemin, srim_table_logemax, srim_table_points);
+        return tables;
+    }
+}
+
+double srim_dedx_e_tabulated(int pZ, int tZ, double energy, bool use_new){
+    if(pZ<1 || tZ<1 || pZ>srim_table_maxz || tZ>srim_table_maxz)return srim_dedx_e(pZ, tZ, energy, use_new);
+    std::size_t i = ((use_new?srim_table_maxz:0) + pZ-1)*srim_table_maxz + tZ-1;
+    return srim_tables()(i, energy, [&](double e){return srim_dedx_e(pZ, tZ, e, use_new);});
+}
+
 const double pse_95[92][8] = {
 //H
 {0.0128116,0.00533047,0.651042,0.531902,1959.01,1.1887,598.263,0.00954514},
@@ -10,6 +10,16 @@ namespace catima{
   */
 double srim_dedx_e(int pZ, int tZ, double energy, bool use_v95=1);
 
+/**
+  * return srim stopping power interpolated from the table of the pZ, tZ combination
+  * the table is calculated on the first use, energies outside of the table and Z above 92 are calculated directly
+  * @param pZ - projectile Z
+  * @param tZ - material Z
+  * @param energy - projectile energy in MeV/u unit
+  * @param use_v95 - use srim proton coefficient from version 95, otherwise version 85 will be used
+  */
+double srim_dedx_e_tabulated(int pZ, int tZ, double energy, bool use_v95=1);
+
 /**
   * return SRIM proton stopping power
   * @param Z - proton number of material
@@ -14,11 +14,14 @@
  */
 
 #include <math.h>
+#include <chrono>
 #include <iostream>
+#include <optional>
 #include "storage.h"
 #include "catima/catima.h"
 namespace catima {
     Data _storage;
+    SharedData _shared_storage(max_shared_storage_data);
     #ifdef VETABLE    
     LogVArray<max_datapoints> energy_table(logEmin,logEmax);
     #else
@@ -110,20 +113,11 @@ double InterpolatorGSL::derivative(double x)const{
     
 
 void Data::Add(const Projectile &p, const Material &t, const Config &c){
-	DataPoint dp(p,t,c);
 	for(auto &e:storage){
-	    if(e==dp)return; 
+	    if( (e.p==p) && (e.m==t) && (e.config==c))return;
 	}
     if(index==storage.end())index=storage.begin();
     *index = calculate_DataPoint(p,t,c);
-#ifdef STORE_SPLINES
-    //index->range_spline = Interpolator(energy_table.values,index->range);
-    //index->range_straggling_spline = Interpolator(energy_table.values,index->range_straggling);
-    //index->angular_variance_spline = Interpolator(energy_table.values,index->angular_variance);
-    index->range_spline = Interpolator(energy_table, index->range);
-    index->range_straggling_spline = Interpolator(energy_table, index->range_straggling);
-    index->angular_variance_spline = Interpolator(energy_table, index->angular_variance);
-#endif
     index++;
     }
     
@@ -138,4 +132,100 @@ void Data::Add(const Projectile &p, const Material &t, const Config &c){
     return *std::prev(index);
     }
 
+SharedData::SharedData(std::size_t capacity):max_size(capacity){
+    storage.reserve(max_size);
+}
+
+std::shared_ptr<const DataPoint> SharedData::Get(const Projectile &p, const Material &t, const Config &c){
+    std::optional<std::promise<std::shared_ptr<const DataPoint>>> promise; // created only if not stored
+    std::shared_future<std::shared_ptr<const DataPoint>> stored;
+    std::size_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto &e:storage){
+            if( (e.p==p) && (e.m==t) && (e.config==c)){
+                stored = e.data;
+                break;
+            }
+        }
+        if(!stored.valid()){
+            promise.emplace();
+            id = next_id++;
+            Entry e{p, t, c, promise->get_future().share(), id};
+            if(storage.size()<max_size){
+                storage.push_back(std::move(e));
+            }
+            else{
+                storage[index] = std::move(e);
+                index = (index+1)%max_size;
+            }
+        }
+    }
+    if(stored.valid())return stored.get(); // waits if still being calculated
+
+    try{
+        auto dp = std::make_shared<const DataPoint>(calculate_DataPoint(p,t,c));
+        promise->set_value(dp);
+        return dp;
+    }
+    catch(...){
+        // failed entry is removed, so the next request calculates it again
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(std::size_t i=0;i<storage.size();i++){
+                if(storage[i].id==id){
+                    storage.erase(storage.begin()+i);
+                    if(index>i)index--;
+                    break;
+                }
+            }
+        }
+        promise->set_exception(std::current_exception());
+        throw;
+    }
+}
+
+void SharedData::Add(std::shared_ptr<const DataPoint> dp){
+    std::promise<std::shared_ptr<const DataPoint>> promise;
+    promise.set_value(dp);
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry e{dp->p, dp->m, dp->config, promise.get_future().share(), next_id++};
+    for(auto &stored:storage){
+        if( (stored.p==e.p) && (stored.m==e.m) && (stored.config==e.config)){
+            stored = std::move(e);
+            return;
+        }
+    }
+    if(storage.size()<max_size){
+        storage.push_back(std::move(e));
+    }
+    else{
+        storage[index] = std::move(e);
+        index = (index+1)%max_size;
+    }
+}
+
+std::vector<std::shared_ptr<const DataPoint>> SharedData::GetStored() const {
+    std::vector<std::shared_ptr<const DataPoint>> res;
+    std::lock_guard<std::mutex> lock(mutex);
+    res.reserve(storage.size());
+    for(auto &e:storage){
+        if(e.data.wait_for(std::chrono::seconds(0)) == std::future_status::ready){
+            res.push_back(e.data.get()); // failed entries are removed, so get() does not throw
+        }
+    }
+    return res;
+}
+
+std::size_t SharedData::GetN() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return storage.size();
+}
+
+void SharedData::Reset(){
+    std::lock_guard<std::mutex> lock(mutex);
+    storage.clear();
+    index = 0;
+}
+
 }
@@ -21,6 +21,9 @@
 #include <array>
 #include <iterator>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <future>
 //#include <unordered_set>
 #include "catima/build_config.h"
 #include "catima/constants.h"
@@ -171,6 +174,8 @@ namespace catima{
         double derivative(double x)const{return ss.deriv(x);}
         double get_min()const{return min;}
         double get_max()const{return max;}
+        /// spline coefficients, at x[i] <= x < x[i+1]: y = ((a[i]*h + b[i])*h + c[i])*h + y[i], h = x - x[i]
+        const cspline_special<xtype>& coefficients()const{return ss;}
 
     private:
         double min=0;
@@ -272,6 +277,56 @@ class DataPoint{
 
     extern Data _storage;
 
+/**
+ * @brief The SharedData class to store DataPoints shared between threads
+ * DataPoints are handed out as shared pointers, so they stay valid while in use
+ * even if they are replaced in the storage meanwhile.
+ * Concurrent requests of the same DataPoint wait for single calculation.
+ */
+    class SharedData{
+    public:
+        explicit SharedData(std::size_t capacity=max_storage_data);
+
+        /**
+         * @brief Get DataPoint for projectile-target-config combination, calculate it if not stored
+         * @param p - Projectile
+         * @param t - Material
+         * @param c - Config
+         * @return shared pointer to DataPoint
+         */
+        std::shared_ptr<const DataPoint> Get(const Projectile &p, const Material &t, const Config &c=default_config);
+
+        /**
+         * @brief Add already calculated DataPoint, it replaces stored DataPoint of the same combination
+         * @param dp - DataPoint, for example loaded by load_tables()
+         */
+        void Add(std::shared_ptr<const DataPoint> dp);
+
+        /// returns already calculated DataPoints, DataPoints being calculated are skipped
+        std::vector<std::shared_ptr<const DataPoint>> GetStored() const;
+
+        std::size_t GetN() const;
+        std::size_t capacity() const {return max_size;}
+        void Reset();
+
+    private:
+        struct Entry{
+            Projectile p;
+            Material m;
+            Config config;
+            std::shared_future<std::shared_ptr<const DataPoint>> data;
+            std::size_t id;
+        };
+        std::size_t max_size;
+        std::size_t index = 0;
+        std::size_t next_id = 0;
+        std::vector<Entry> storage;
+        mutable std::mutex mutex;
+    };
+
+    /// DataPoints shared by the multi-threaded calculations
+    extern SharedData _shared_storage;
+
     /**
      * @brief get_data - Get DataPoint from the global storage class
      * @param p - Projectile
@@ -2,6 +2,7 @@
 #include "catima/nucdata.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 
 namespace catima{
@@ -15,6 +16,7 @@ bool operator==(const Projectile &a, const Projectile&b){
 }
 
 bool operator==(const Material &a, const Material&b){
+    if(a.fp != b.fp)return false;
     if(std::fabs(a.density() - b.density())> 1e-6)return false;
     if(a.ncomponents() != b.ncomponents())return false;
     if(a.I() != b.I())return false;
@@ -37,6 +39,7 @@ Material::Material(std::initializer_list<std::array<double,3>>list,double _densi
 
     if(mass!=0.0){
         molar_mass=mass;
+        update_fingerprint();
         }
     else{
         calculate(); // calculate if needed, ie average molar mass
@@ -51,6 +54,7 @@ void Material::add_element(double _a, int _z, double _stn){
     double a = (_a>0)?_a:element_atomic_weight(_z);
     atoms.push_back({a,_z,_stn});
     molar_mass += _stn*a;
+    update_fingerprint();
 }
 
 void Material::calculate(){
@@ -60,10 +64,35 @@ void Material::calculate(){
             sum+= e.stn/e.A;
         }
         molar_mass = 1.0/sum;
+        update_fingerprint();
     }
 }
 
-void Layers::add(Material m){
+namespace{
+    // FNV-1a over the bit pattern of the value, -0.0 is hashed as 0.0 as they compare equal
+    std::uint64_t fnv1a(std::uint64_t h, double v){
+        std::uint64_t bits = 0;
+        if(v!=0.0)std::memcpy(&bits,&v,sizeof(bits));
+        for(int i=0;i<8;i++){
+            h ^= (bits>>(8*i))&0xff;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+}
+
+void Material::update_fingerprint(){
+    std::uint64_t h = 14695981039346656037ull;
+    for(const auto &e:atoms){
+        h = fnv1a(h,e.A);
+        h = fnv1a(h,e.Z);
+        h = fnv1a(h,e.stn);
+    }
+    h = fnv1a(h,i_potential);
+    fp = fnv1a(h,molar_mass);
+}
+
+void Layers::add(const Material &m){
     materials.push_back(m);
 }
 
@@ -17,10 +17,12 @@
 #ifndef STRUCTURES_H
 #define STRUCTURES_H
 
+#include <cstdint>
 #include <vector>
 #include <array>
 #include <initializer_list>
 #include "catima/constants.h"
+#include "catima/small_vector.h"
 
 namespace catima{
 
@@ -73,7 +75,9 @@ namespace catima{
             double th=0;
             double molar_mass=0;
             double i_potential=0;
-            std::vector<Target>atoms;
+            std::uint64_t fp=0;
+            small_vector<Target, material_inline_elements> atoms;
+            void update_fingerprint();
 
         public:
             Material(){};
@@ -144,7 +148,7 @@ namespace catima{
             /**
               * sets molar mass of the Material
               */
-            Material& M(double mass){molar_mass=mass; return *this;}
+            Material& M(double mass){molar_mass=mass; update_fingerprint(); return *this;}
 
             /**
               * @return returns density in g/cm^3
@@ -179,7 +183,7 @@ namespace catima{
             /**
               * set the mean ionization potential, if non elemental I should be used
               */
-            Material& I(double val){i_potential = val;return *this;};
+            Material& I(double val){i_potential = val; update_fingerprint(); return *this;};
 
             /**
               * 0 if default elemental potential is used
@@ -187,6 +191,13 @@ namespace catima{
               */
             double I() const {return i_potential;};
 
+            /**
+              * hash of the components, ionisation potential and molar mass,
+              * it is updated when the Material is modified, density and thickness are not included
+              * @return fingerprint of the Material
+              */
+            std::uint64_t fingerprint() const {return fp;};
+
             /**
               * return number density of atoms/molecules per cm3 in 10^23 units
               */
@@ -278,7 +289,7 @@ namespace catima{
           * add Material m to the Layers
           * @param m Material
           */
-        void add(Material m);
+        void add(const Material &m);
 
 	/**
 	 * append Layers
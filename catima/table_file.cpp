@@ -0,0 +1,183 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include "catima/table_file.h"
+#include "catima/byte_order.h"
+
+namespace catima{
+
+static_assert(sizeof(TableFileHeader)%8==0 && sizeof(TableFileRecord)%8==0, "table file arrays must stay 8 bytes aligned");
+static_assert(sizeof(Config)<=sizeof(TableFileRecord::config), "Config does not fit to TableFileRecord");
+
+namespace{
+    // the file is little-endian, the values are converted on big-endian hosts
+    void convert_file_order(TableFileHeader &h){
+        h.version = convert_little_endian(h.version);
+        h.byte_order = convert_little_endian(h.byte_order);
+        h.ndata = convert_little_endian(h.ndata);
+        h.npoints = convert_little_endian(h.npoints);
+        h.nelements = convert_little_endian(h.nelements);
+        h.logemin = convert_little_endian(h.logemin);
+        h.logemax = convert_little_endian(h.logemax);
+    }
+
+    void convert_file_order(TableFileRecord &r){
+        for(double *v:{&r.pa, &r.pz, &r.pq, &r.density, &r.ipot, &r.molar_mass})*v = convert_little_endian(*v);
+        r.first_element = convert_little_endian(r.first_element);
+        r.nelements = convert_little_endian(r.nelements);
+    }
+
+    void convert_file_order(double &v){
+        v = convert_little_endian(v);
+    }
+
+    template<typename T>
+    void write_array(std::ofstream &f, const T *data, std::size_t n){
+        if(host_little_endian()){
+            f.write(reinterpret_cast<const char*>(data), n*sizeof(T));
+            return;
+        }
+        for(std::size_t i=0;i<n;i++){
+            T v = data[i];
+            convert_file_order(v);
+            f.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+    }
+
+    template<typename T>
+    bool read_array(std::ifstream &f, T *data, std::size_t n){
+        if(!f.read(reinterpret_cast<char*>(data), n*sizeof(T)))return false;
+        if(!host_little_endian()){
+            for(std::size_t i=0;i<n;i++)convert_file_order(data[i]);
+        }
+        return true;
+    }
+
+    bool same_energy_grid(const std::vector<double> &energy){
+        if(energy.size() != static_cast<std::size_t>(max_datapoints))return false;
+        for(int i=0;i<max_datapoints;i++){
+            if(std::fabs(energy[i]-energy_table[i]) > 1e-12*energy_table[i])return false;
+        }
+        return true;
+    }
+}
+
+bool save_tables(const char *filename, const std::vector<std::shared_ptr<const DataPoint>> &data){
+    std::ofstream f(filename, std::ios::out|std::ios::binary);
+    if(!f)return false;
+
+    std::vector<TableFileRecord> records;
+    std::vector<double> elements;
+    records.reserve(data.size());
+    for(const auto &dp:data){
+        TableFileRecord r{};
+        r.pa = dp->p.A;
+        r.pz = dp->p.Z;
+        r.pq = dp->p.Q;
+        r.density = dp->m.density();
+        r.ipot = dp->m.I();
+        r.molar_mass = dp->m.M();
+        r.first_element = elements.size()/3;
+        r.nelements = dp->m.ncomponents();
+        std::memcpy(r.config, &dp->config, sizeof(Config));
+        for(int i=0;i<dp->m.ncomponents();i++){
+            Target e = dp->m.get_element(i);
+            elements.push_back(e.A);
+            elements.push_back(e.Z);
+            elements.push_back(e.stn);
+        }
+        records.push_back(r);
+    }
+
+    TableFileHeader h;
+    h.ndata = data.size();
+    h.npoints = max_datapoints;
+    h.nelements = elements.size()/3;
+    write_array(f, &h, 1);
+    for(int i=0;i<max_datapoints;i++){
+        double e = energy_table[i];
+        write_array(f, &e, 1);
+    }
+    write_array(f, records.data(), records.size());
+    write_array(f, elements.data(), elements.size());
+    for(const auto &dp:data)write_array(f, dp->range.data(), max_datapoints);
+    for(const auto &dp:data)write_array(f, dp->range_straggling.data(), max_datapoints);
+    for(const auto &dp:data)write_array(f, dp->angular_variance.data(), max_datapoints);
+    return static_cast<bool>(f);
+}
+
+bool load_tables(const char *filename, std::vector<std::shared_ptr<const DataPoint>> &data){
+    std::ifstream f(filename, std::ios::in|std::ios::binary);
+    if(!f)return false;
+
+    f.seekg(0, std::ios::end);
+    const std::uint64_t file_size = static_cast<std::uint64_t>(f.tellg());
+    f.seekg(0, std::ios::beg);
+
+    TableFileHeader h;
+    const TableFileHeader expected;
+    if(!read_array(f, &h, 1))return false;
+    if(std::memcmp(h.magic, expected.magic, sizeof(h.magic))!=0 || h.version!=expected.version || h.byte_order!=expected.byte_order){
+        return false;
+    }
+    if(h.npoints != static_cast<std::uint64_t>(max_datapoints))return false;
+
+    // counts are checked against the file size before anything is allocated, the divisions avoid overflow
+    const std::uint64_t data_size = sizeof(TableFileRecord) + 3*sizeof(double)*h.npoints; // bytes per DataPoint
+    const std::uint64_t element_size = 3*sizeof(double);
+    if(file_size < sizeof(TableFileHeader) + sizeof(double)*h.npoints)return false;
+    std::uint64_t available = file_size - sizeof(TableFileHeader) - sizeof(double)*h.npoints;
+    if(h.ndata > available/data_size)return false;
+    available -= h.ndata*data_size;
+    if(h.nelements > available/element_size || available != h.nelements*element_size)return false;
+
+    std::vector<double> energy(h.npoints);
+    std::vector<TableFileRecord> records(h.ndata);
+    std::vector<double> elements(3*h.nelements);
+    if(!read_array(f, energy.data(), energy.size()))return false;
+    if(!same_energy_grid(energy))return false;
+    if(!read_array(f, records.data(), records.size()))return false;
+    if(!read_array(f, elements.data(), elements.size()))return false;
+
+    std::vector<DataPoint> loaded(h.ndata);
+    for(std::size_t k=0;k<records.size();k++){
+        const TableFileRecord &r = records[k];
+        if(r.first_element > h.nelements || r.nelements > h.nelements-r.first_element)return false;
+        DataPoint &dp = loaded[k];
+        dp.p = Projectile(r.pa, r.pz, r.pq);
+        for(std::uint64_t i=r.first_element;i<r.first_element+r.nelements;i++){
+            if(!(elements[3*i+1]>=0.0 && elements[3*i+1]<=std::numeric_limits<int>::max()))return false;
+            dp.m.add_element(elements[3*i], static_cast<int>(elements[3*i+1]), elements[3*i+2]);
+        }
+        dp.m.density(r.density).I(r.ipot).M(r.molar_mass);
+        std::memcpy(&dp.config, r.config, sizeof(Config));
+        dp.range.resize(max_datapoints);
+        dp.range_straggling.resize(max_datapoints);
+        dp.angular_variance.resize(max_datapoints);
+    }
+    for(auto &dp:loaded)if(!read_array(f, dp.range.data(), max_datapoints))return false;
+    for(auto &dp:loaded)if(!read_array(f, dp.range_straggling.data(), max_datapoints))return false;
+    for(auto &dp:loaded)if(!read_array(f, dp.angular_variance.data(), max_datapoints))return false;
+
+    data.reserve(data.size()+loaded.size());
+    for(auto &dp:loaded){
+        #ifdef STORE_SPLINES
+        // vectors are moved together with DataPoint, so the splines stay valid
+        dp.range_spline = Interpolator(energy_table, dp.range);
+        dp.range_straggling_spline = Interpolator(energy_table, dp.range_straggling);
+        dp.angular_variance_spline = Interpolator(energy_table, dp.angular_variance);
+        #endif
+        data.push_back(std::make_shared<const DataPoint>(std::move(dp)));
+    }
+    return true;
+}
+
+bool load_tables(const char *filename, SharedData &storage){
+    std::vector<std::shared_ptr<const DataPoint>> data;
+    if(!load_tables(filename, data))return false;
+    for(auto &dp:data)storage.Add(std::move(dp));
+    return true;
+}
+
+}
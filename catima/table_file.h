@@ -0,0 +1,87 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_TABLE_FILE_H
+#define CATIMA_TABLE_FILE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "catima/constants.h"
+#include "catima/storage.h"
+
+namespace catima{
+
+/**
+ * Binary file of DataPoint tables, all values are little-endian on every host and every array starts at multiple
+ * of 8 bytes, so the file can be memory mapped. The file consists of:
+ *   TableFileHeader
+ *   double energy[npoints]                  - energy grid in MeV/u
+ *   TableFileRecord records[ndata]          - projectile, material and config of the DataPoints
+ *   double elements[nelements][3]           - A, Z, stn of the material elements
+ *   double range[ndata][npoints]
+ *   double range_straggling[ndata][npoints]
+ *   double angular_variance[ndata][npoints]
+ */
+struct TableFileHeader{
+    char magic[8] = {'C','A','T','I','M','A','T','B'};
+    std::uint32_t version = 1;
+    std::uint32_t byte_order = 0x01020304; // format sanity marker, stored as bytes 04 03 02 01
+    std::uint64_t ndata = 0;
+    std::uint64_t npoints = 0;
+    std::uint64_t nelements = 0;
+    double logemin = logEmin;
+    double logemax = logEmax;
+};
+
+struct TableFileRecord{
+    double pa;
+    double pz;
+    double pq;
+    double density;
+    double ipot;
+    double molar_mass;
+    std::uint64_t first_element; // index of the first element of the material in the elements array
+    std::uint64_t nelements;
+    unsigned char config[8];
+};
+
+/**
+ * writes DataPoints and the energy grid to the binary file
+ * @param filename - name of the file
+ * @param data - DataPoints to store, for example from _shared_storage or get_data_batch()
+ * @return false if the file could not be written
+ */
+bool save_tables(const char *filename, const std::vector<std::shared_ptr<const DataPoint>> &data);
+
+/**
+ * reads DataPoints from the binary file, the splines are rebuilt from the tables without recalculation
+ * the file is rejected if its energy grid is different from the energy_table of this build
+ * @param filename - name of the file
+ * @param data - loaded DataPoints are appended
+ * @return false if the file could not be read, is truncated, corrupted or not compatible
+ */
+bool load_tables(const char *filename, std::vector<std::shared_ptr<const DataPoint>> &data);
+
+/**
+ * reads DataPoints from the binary file and stores them to the cache
+ * subsequent calculations with the same projectile, material and config use the loaded tables
+ * @return false if the file could not be read or is not compatible
+ */
+bool load_tables(const char *filename, SharedData &storage=_shared_storage);
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "catima/thread_pool.h"
+#include <algorithm>
+
+namespace catima{
+
+namespace{
+    thread_local bool is_worker = false;
+}
+
+ThreadPool::ThreadPool(unsigned int nthreads){
+    if(nthreads==0)nthreads = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned int i=0;i<nthreads;i++){
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for(unsigned int i=0;i+1<nthreads;i++){
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for(auto &w:workers){
+        w.join();
+    }
+}
+
+bool ThreadPool::inside_worker(){
+    return is_worker;
+}
+
+bool ThreadPool::pop(std::size_t id, Range &r){
+    // own queue first, LIFO
+    {
+        Queue &q = *queues[id];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(!q.tasks.empty()){
+            r = q.tasks.back();
+            q.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    // steal from the others, FIFO
+    for(std::size_t i=1;i<queues.size();i++){
+        Queue &q = *queues[(id+i)%queues.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(!q.tasks.empty()){
+            r = q.tasks.front();
+            q.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::execute(Range &r){
+    Batch &b = *r.batch;
+    try{
+        b.body(r.begin, r.end);
+    }
+    catch(...){
+        std::lock_guard<std::mutex> lock(b.mutex);
+        if(!b.error)b.error = std::current_exception();
+    }
+    if(b.pending.fetch_sub(r.end-r.begin) == (r.end-r.begin)){
+        // batch must not be touched after the lock is released
+        std::lock_guard<std::mutex> lock(b.mutex);
+        b.finished = true;
+        b.done.notify_all();
+    }
+}
+
+void ThreadPool::worker_loop(std::size_t id){
+    is_worker = true;
+    Range r;
+    while(true){
+        if(pop(id, r)){
+            execute(r);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.wait(lock, [this]{return stop || queued>0;});
+        if(stop && queued==0)return;
+    }
+}
+
+void ThreadPool::run(std::function<void(std::size_t, std::size_t)> body, std::size_t n, std::size_t grain){
+    // batches of concurrent callers share the queues, every range points to its own batch
+    Batch batch;
+    batch.body = std::move(body);
+    batch.pending = n;
+
+    // contiguous blocks of chunks per queue, neighbouring indices stay on the same thread
+    std::size_t nchunks = (n+grain-1)/grain;
+    std::size_t per_queue = (nchunks+queues.size()-1)/queues.size();
+    std::size_t chunk = 0;
+    for(std::size_t qi=0;qi<queues.size();qi++){
+        Queue &q = *queues[qi];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        for(std::size_t k=0;k<per_queue && chunk<nchunks;k++,chunk++){
+            std::size_t begin = chunk*grain;
+            // pushed in reverse so the owner processes its chunks in increasing order
+            q.tasks.push_front({begin, std::min(n, begin+grain), &batch});
+            queued++;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake.notify_all();
+
+    // calling thread helps until there is nothing left to take, possibly with ranges of other batches
+    std::size_t id = queues.size()-1;
+    Range r;
+    bool was_worker = is_worker;
+    is_worker = true;
+    while(batch.pending>0 && pop(id, r)){
+        execute(r);
+    }
+    is_worker = was_worker;
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&batch]{return batch.finished;});
+    if(batch.error)std::rethrow_exception(batch.error);
+}
+
+ThreadPool& default_thread_pool(){
+    static ThreadPool pool;
+    return pool;
+}
+
+}
@@ -0,0 +1,146 @@
+/*
+ *  Copyright(C) 2017
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CATIMA_THREAD_POOL_H
+#define CATIMA_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace catima{
+
+/**
+ * @brief work-stealing thread pool
+ * Every worker has its own queue of index ranges, it takes work from the back of its own queue
+ * and when empty it steals from the front of the other queues.
+ * The thread calling parallel_for participates in the work.
+ * parallel_for can be called concurrently from several outside threads,
+ * their batches are queued together and processed by all workers.
+ *
+ * Example usage:
+ * \code{.cpp}
+ * ThreadPool pool(4);
+ * std::vector<double> res(1000);
+ * pool.parallel_for(res.size(), [&](std::size_t i){res[i] = f(i);});
+ * \endcode
+ */
+class ThreadPool{
+public:
+    /**
+     * @param nthreads - number of threads including the calling one, 0 means hardware concurrency
+     */
+    explicit ThreadPool(unsigned int nthreads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// number of threads including calling thread
+    unsigned int size() const {return static_cast<unsigned int>(workers.size()) + 1;}
+
+    /**
+     * calls f(i) for every i in [0,n) and waits until all are finished
+     * the indices are split into chunks of grain size, if grain is 0 it is chosen automatically
+     * if called from inside of the worker the loop is executed serially
+     * the first exception thrown by f is rethrown
+     */
+    template<typename F>
+    void parallel_for(std::size_t n, F&& f, std::size_t grain = 0){
+        if(n==0)return;
+        if(grain==0)grain = std::max<std::size_t>(1, n/(8*size()));
+        if(size()==1 || inside_worker() || n<=grain){
+            for(std::size_t i=0;i<n;i++)f(i);
+            return;
+        }
+        run([&f](std::size_t begin, std::size_t end){
+            for(std::size_t i=begin;i<end;i++)f(i);
+            }, n, grain);
+    }
+
+    /// return true if called from one of the pool threads
+    static bool inside_worker();
+
+private:
+    struct Batch{
+        std::function<void(std::size_t, std::size_t)> body;
+        std::atomic<std::size_t> pending{0};
+        std::exception_ptr error;
+        bool finished = false;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    struct Range{
+        std::size_t begin;
+        std::size_t end;
+        Batch *batch;
+    };
+    /// double ended ring buffer of tasks, the capacity is kept so the warm pool does not allocate
+    class RangeQueue{
+    public:
+        bool empty() const {return count==0;}
+        Range& front(){return buf[head];}
+        Range& back(){return buf[(head+count-1)%buf.size()];}
+        void pop_front(){head = (head+1)%buf.size(); count--;}
+        void pop_back(){count--;}
+        void push_front(const Range &r){
+            if(count==buf.size())grow();
+            head = (head+buf.size()-1)%buf.size();
+            buf[head] = r;
+            count++;
+        }
+    private:
+        void grow(){
+            std::vector<Range> b(std::max<std::size_t>(16, 2*buf.size()));
+            for(std::size_t i=0;i<count;i++)b[i] = buf[(head+i)%buf.size()];
+            buf.swap(b);
+            head = 0;
+        }
+        std::vector<Range> buf;
+        std::size_t head = 0;
+        std::size_t count = 0;
+    };
+    struct Queue{
+        std::mutex mutex;
+        RangeQueue tasks;
+    };
+
+    void run(std::function<void(std::size_t, std::size_t)> body, std::size_t n, std::size_t grain);
+    void worker_loop(std::size_t id);
+    bool pop(std::size_t id, Range &r);
+    void execute(Range &r);
+
+    std::vector<std::unique_ptr<Queue>> queues; // last queue belongs to the calling thread
+    std::vector<std::thread> workers;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<std::size_t> queued{0};
+    bool stop = false;
+};
+
+/**
+ * returns thread pool shared by library functions
+ * the pool is created at first use with hardware concurrency threads
+ */
+ThreadPool& default_thread_pool();
+
+}
+#endif
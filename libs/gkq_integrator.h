@@ -15,14 +15,66 @@
 
 #ifndef GKQ_INTEGRATOR_H
 #define GKQ_INTEGRATOR_H
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <limits>
+#include <memory>
 #include <utility>
 #include <vector>
 
 namespace integrators{
 
+/// result of the adaptive integration using the workspace
+struct GKResult{
+    double value = 0.0;   ///< integral
+    double error = 0.0;   ///< estimated absolute error
+    int neval = 0;        ///< number of function evaluations
+    int nintervals = 0;   ///< number of intervals at the end of integration
+    bool converged = false; ///< true if the requested tolerance was reached
+};
+
+/**
+ * @brief workspace of the adaptive integration
+ * the intervals are stored in the heap ordered by error, the memory is allocated
+ * only in the constructor so the integrations reusing the workspace do not allocate
+ */
+class GKWorkspace{
+public:
+    struct Interval{
+        double a;
+        double b;
+        double value;
+        double error;
+    };
+
+    /**
+     * @param limit - maximum number of intervals
+     */
+    explicit GKWorkspace(std::size_t limit = 200):intervals(std::max<std::size_t>(limit,1)){}
+    std::size_t limit() const {return intervals.size();}
+
+    /// number of intervals of the last integration
+    std::size_t size() const {return num;}
+    const Interval& operator[](std::size_t i) const {return intervals[i];}
+
+private:
+    template<int order> friend class GaussKronrodIntegration;
+    static bool cmp(const Interval &x, const Interval &y){return x.error<y.error;}
+    void clear(){num = 0;}
+    void push(const Interval &i){
+        intervals[num++] = i;
+        std::push_heap(intervals.begin(), intervals.begin()+num, cmp);
+    }
+    Interval pop(){
+        std::pop_heap(intervals.begin(), intervals.begin()+num, cmp);
+        return intervals[--num];
+    }
+    std::vector<Interval> intervals;
+    std::size_t num = 0;
+};
+
 template<int order>
 struct GK_data{
 };
@@ -47,6 +99,48 @@ public:
     template<typename F>
     static double integrate_adaptive(F& f, double a, double b, double eps = 1e-3, double reps=1e-6, int level=49);
 
+    /**
+     * adaptive integration, the interval with the largest error is bisected until
+     * the total error is below max(eps, reps*|I|), the workspace is full or the evaluation budget is spent
+     * @param w - workspace, can be reused for other integrations
+     * @param max_eval - maximum number of function evaluations, 0 means limited only by the workspace size
+     */
+    template<typename F>
+    static GKResult integrate_workspace(F& f, double a, double b, GKWorkspace& w, double eps = 1e-3, double reps=1e-6, int max_eval=0);
+
+    /**
+     * adaptive integration over the sum of n intervals, see integrate_workspace(f, a, b, w, eps, reps, max_eval)
+     */
+    template<typename F>
+    static GKResult integrate_workspace(F& f, const std::pair<double,double>* intervals, std::size_t n, GKWorkspace& w, double eps = 1e-3, double reps=1e-6, int max_eval=0);
+
+    /**
+     * workspace of the calling thread used by integrate and integrate_intervals
+     * every nesting level of the integration has its own workspace, so the integrated
+     * function can call integrate again, the workspace is released at the end of the scope
+     */
+    class ScopedWorkspace{
+    public:
+        ScopedWorkspace(){
+            if(depth()==stack().size())stack().emplace_back(new GKWorkspace());
+            w = stack()[depth()++].get();
+        }
+        ~ScopedWorkspace(){depth()--;}
+        ScopedWorkspace(const ScopedWorkspace&) = delete;
+        ScopedWorkspace& operator=(const ScopedWorkspace&) = delete;
+        GKWorkspace& get(){return *w;}
+    private:
+        static std::vector<std::unique_ptr<GKWorkspace>>& stack(){
+            static thread_local std::vector<std::unique_ptr<GKWorkspace>> s;
+            return s;
+        }
+        static std::size_t& depth(){
+            static thread_local std::size_t d = 0;
+            return d;
+        }
+        GKWorkspace *w;
+    };
+
     static double w(int i) {return GK_data<order>::w()[i];}
     static double wg(int i) {return GK_data<order>::wg()[i];}
     static double x(int i) {return GK_data<order>::x()[i];}
@@ -127,14 +221,79 @@ double GaussKronrodIntegration<order>::integrate_adaptive(F& f, double a, double
     return result;
     }
 
+template<int order>
+template<typename F>
+GKResult GaussKronrodIntegration<order>::integrate_workspace(F& f, const std::pair<double,double>* intervals, std::size_t n, GKWorkspace& w, double eps, double reps, int max_eval){
+    GKResult res;
+    w.clear();
+    // intervals which do not fit into the workspace are not refined
+    double fixed_value = 0.0;
+    double fixed_error = 0.0;
+    for(std::size_t i=0;i<n;i++){
+        auto r = integrate_nonadaptive(f, intervals[i].first, intervals[i].second);
+        res.value += r.first;
+        res.error += r.second;
+        res.neval += order;
+        if(i<w.limit()){
+            w.push({intervals[i].first, intervals[i].second, r.first, r.second});
+        }
+        else{
+            fixed_value += r.first;
+            fixed_error += r.second;
+        }
+    }
+    if(n==0)return res;
+
+    const double numlimit = 10*std::numeric_limits<double>::epsilon();
+    while(true){
+        if(res.error <= std::max(reps*std::abs(res.value), eps)){
+            res.converged = true;
+            break;
+        }
+        if(w.size()+1 > w.limit())break;
+        if(max_eval>0 && res.neval + 2*order > max_eval)break;
+        GKWorkspace::Interval i = w.pop();
+        const double mid = 0.5*(i.a+i.b);
+        if((i.b-i.a) < numlimit*std::max(std::abs(i.a),std::abs(i.b)) || mid<=i.a || mid>=i.b){
+            w.push(i); // interval cannot be divided further
+            break;
+        }
+        auto r1 = integrate_nonadaptive(f, i.a, mid);
+        auto r2 = integrate_nonadaptive(f, mid, i.b);
+        res.neval += 2*order;
+        w.push({i.a, mid, r1.first, r1.second});
+        w.push({mid, i.b, r2.first, r2.second});
+        res.value += r1.first + r2.first - i.value;
+        res.error += r1.second + r2.second - i.error;
+    }
+
+    // sum again to remove accumulated rounding of the updates
+    res.value = fixed_value;
+    res.error = fixed_error;
+    for(std::size_t i=0;i<w.size();i++){
+        res.value += w[i].value;
+        res.error += w[i].error;
+    }
+    res.nintervals = static_cast<int>(w.size());
+    return res;
+}
+
+template<int order>
+template<typename F>
+GKResult GaussKronrodIntegration<order>::integrate_workspace(F& f, double a, double b, GKWorkspace& w, double eps, double reps, int max_eval){
+    std::pair<double,double> interval(a,b);
+    return integrate_workspace(f, &interval, 1, w, eps, reps, max_eval);
+}
+
 template<int order>
 template<typename F>
 double GaussKronrodIntegration<order>::integrate(F& f, double a, double b, double eps, double reps, int N){
     double step = (b-a)/N;
     double result = 0;
+    ScopedWorkspace w;
     for(int i=0; i<N;i++){
         double m =a+(i*step);
-        result+=integrate_adaptive(f,m,m+step, eps/N, reps);
+        result+=integrate_workspace(f,m,m+step, w.get(), eps/N, reps).value;
     }
 
     return result;
@@ -144,8 +303,9 @@ template<int order>
 template<typename F>
 double GaussKronrodIntegration<order>::integrate_intervals(F& f, const std::vector<std::pair<double,double>>& intervals, double eps, double reps){
     double result = 0;
+    ScopedWorkspace w;
     for(auto& i:intervals){
-        result+=integrate_adaptive(f,i.first,i.second, eps/intervals.size(), reps);
+        result+=integrate_workspace(f,i.first,i.second, w.get(), eps/intervals.size(), reps).value;
     }
 
     return result;
@@ -15,6 +15,7 @@
 #ifndef GLQ_INTEGRATOR_H
 #define GLQ_INTEGRATOR_H
 #include <array>
+#include <cstddef>
 
 namespace integrators{
 
@@ -29,6 +30,22 @@ public:
     double integrate(F& f, double a, double b) const;
     template<typename F>
     double operator()(F& f, double a, double b) const {return integrate(f, a, b);}
+
+    /**
+      * integrates f over (a,b), all nodes are evaluated with single call
+      * @param f - batch function f(const double *x, double *y, std::size_t n) filling y[i]=f(x[i])
+      */
+    template<typename F>
+    double integrate_batch(F& f, double a, double b) const;
+
+    /**
+      * integrates f over n intervals (a[i],b[i]), results are stored to res
+      * nodes of many intervals are evaluated with single call of batch function f
+      * @param f - batch function f(const double *x, double *y, std::size_t n) filling y[i]=f(x[i])
+      */
+    template<typename F>
+    void integrate_batch(F& f, const double *a, const double *b, double *res, std::size_t n) const;
+
     double w(int i) const {return GL_data<order>::w()[i];}
     double x(int i) const {return GL_data<order>::x()[i];}
     int n() const {return order;}
@@ -49,6 +66,47 @@ double GaussLegendreIntegration<order>::integrate(F& f, double a, double b) cons
     return p*res;
 }
 
+// the nodes of the interval are stored in the order of weights, the symmetric nodes are next to each other
+template<int order>
+template<typename F>
+double GaussLegendreIntegration<order>::integrate_batch(F& f, double a, double b) const{
+    double res;
+    integrate_batch(f, &a, &b, &res, 1);
+    return res;
+}
+
+template<int order>
+template<typename F>
+void GaussLegendreIntegration<order>::integrate_batch(F& f, const double *a, const double *b, double *res, std::size_t n) const{
+    constexpr std::size_t chunk = 1 + 512/order;
+    double nodes[chunk*order];
+    double values[chunk*order];
+    for(std::size_t begin=0;begin<n;begin+=chunk){
+        const std::size_t m = (n-begin<chunk)?(n-begin):chunk;
+        std::size_t k = 0;
+        for(std::size_t j=0;j<m;j++){
+            double p = 0.5*(b[begin+j]-a[begin+j]);
+            double q = 0.5*(b[begin+j]+a[begin+j]);
+            if(order%2){nodes[k++] = p*x(0) + q;}
+            for(int i=order%2;i<order/2 + order%2;i++){
+                nodes[k++] = p*x(i) + q;
+                nodes[k++] = -p*x(i) + q;
+            }
+        }
+        f(static_cast<const double*>(nodes), static_cast<double*>(values), k);
+        k = 0;
+        for(std::size_t j=0;j<m;j++){
+            double r = 0.0;
+            if(order%2){r += w(0)*values[k++];}
+            for(int i=order%2;i<order/2 + order%2;i++){
+                r += w(i)*(values[k] + values[k+1]);
+                k += 2;
+            }
+            res[begin+j] = 0.5*(b[begin+j]-a[begin+j])*r;
+        }
+    }
+}
+
 template<int order>
 std::array<double,order> GaussLegendreIntegration<order>::get_points(double a,  double b)const{
     std::array<double,order> points;
@@ -132,6 +190,20 @@ double GaussLegendreIntegration2DA<order, order2>::integrate(F& f, double a, dou
 }
 
 /// weights
+//order = 2
+template<>
+struct GL_data<2>{
+    static const std::array<double,1>& x(){
+        static const std::array<double,1> _x = {0.5773502691896257645091488};
+        return _x;
+    }
+
+    static const std::array<double,1>& w(){
+        static const std::array<double,1> _w = {1.0};
+        return _w;
+    }
+};
+
 //order = 3
 
 template<>
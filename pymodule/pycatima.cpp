@@ -4,11 +4,14 @@
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 #include "catima/catima.h"
+#include "catima/batch.h"
 #include "catima/srim.h"
 #include "catima/nucdata.h"
 #include "catima/convert.h"
 #include <iostream>
 #include <string>
+#include <array>
+#include <utility>
 
 namespace py = pybind11;
 using namespace catima;
@@ -28,53 +31,108 @@ std::string  material_to_string(const Material &r){
                 return s;
             };
 
+py::dict datapoint_info(const DataPoint &data, const char *storage){
+    py::dict d;
+    py::list p;
+    p.append(data.p.A);
+    p.append(data.p.Z);
+    d["projectile"] = p;
+    d["matter"] = material_to_string(data.m);
+    d["config"] = py::cast(data.config);
+    d["storage"] = storage;
+    return d;
+}
+
+// DataPoints of the shared storage used by get_data and the array views, followed by the single-threaded storage
 py::list storage_info(){
     py::list res;
+    for(auto &data:_shared_storage.GetStored()){
+        res.append(datapoint_info(*data, "shared"));
+    }
     for(int i=0; i<max_storage_data;i++){
         auto& data = _storage.Get(i);
         if(data.p.A>0 && data.p.Z && data.m.ncomponents()>0){
-            py::list mat;
-            py::dict d;
-            py::list p;
-            p.append(data.p.A);
-            p.append(data.p.Z);
-            d["projectile"] = p;
-            d["matter"] = material_to_string(data.m);
-            d["config"] = py::cast(data.config);
-            res.append(d);
+            res.append(datapoint_info(data, "single"));
         }
     }
     return res;
 }
 
-py::list get_energy_table(){
-    py::list r;
-    for (size_t i = 0; i < energy_table.size(); i++)
-    {
-        r.append(energy_table[i]);
-    }
-    
-    //for(auto e : energy_table){
-        //r.append(e);
-    //}
-    return r;
+// read-only array viewing n doubles owned by base, the data are copied if base is null
+py::array_t<double> readonly_view(const double *ptr, std::size_t n, py::handle base){
+    py::array_t<double> a(static_cast<py::ssize_t>(n), ptr, base);
+    py::detail::array_proxy(a.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+    return a;
+}
+
+// keeps the DataPoint alive as long as arrays viewing its tables exist
+py::capsule datapoint_owner(std::shared_ptr<const DataPoint> dp){
+    return py::capsule(new std::shared_ptr<const DataPoint>(std::move(dp)),
+                       [](void *ptr){delete static_cast<std::shared_ptr<const DataPoint>*>(ptr);});
+}
+
+std::shared_ptr<const DataPoint> get_shared_data(const Projectile &p, const Material &m, const Config &c){
+    py::gil_scoped_release release;
+    return _shared_storage.Get(p, m, c);
 }
 
-py::list get_data(Projectile& p, const Material &m, const Config& c=default_config){
+py::array_t<double> get_energy_table(){
+#ifdef VETABLE
+    std::array<double, max_datapoints> values;
+    for(int i=0;i<max_datapoints;i++)values[i] = energy_table[i];
+    return readonly_view(values.data(), values.size(), py::handle());
+#else
+    py::capsule global_table(static_cast<const void*>(energy_table.values)); // static storage, nothing to release
+    return readonly_view(energy_table.values, max_datapoints, global_table);
+#endif
+}
+
+// range, range straggling and angular variance tables as read-only views of the cached DataPoint
+py::list get_data(const Projectile& p, const Material &m, const Config& c=default_config){
+    auto dp = get_shared_data(p, m, c);
+    py::capsule owner = datapoint_owner(dp);
     py::list r;
-    auto& data = _storage.Get(p, m, c);
-    py::list ran;
-    py::list rans;
-    py::list av;
-    for(double e:data.range){ran.append(e);}
-    for(double e:data.range_straggling)rans.append(e);
-    for(double e:data.angular_variance)av.append(e);
-    r.append(ran);
-    r.append(rans);
-    r.append(av);
+    r.append(readonly_view(dp->range.data(), dp->range.size(), owner));
+    r.append(readonly_view(dp->range_straggling.data(), dp->range_straggling.size(), owner));
+    r.append(readonly_view(dp->angular_variance.data(), dp->angular_variance.size(), owner));
     return r;
 }
 
+/**
+ * cubic spline of the DataPoint table, one of "range", "range_straggling" or "angular_variance"
+ * at x[i] <= T < x[i+1]: y = ((a[i]*h + b[i])*h + c[i])*h + y[i], h = T - x[i]
+ * below x[0]: y = c0*h + y[0], above x[n-1]: y = c[n-1]*h + y[n-1]
+ */
+py::dict get_spline_coefficients(const Projectile &p, const Material &m, const std::string &table, const Config &c){
+#ifdef GSL_INTERPOLATION
+    throw std::runtime_error("spline coefficients are not available with GSL interpolation");
+#else
+    spline_type (*get_spline)(const DataPoint&) = nullptr;
+    if(table=="range")get_spline = &get_range_spline;
+    else if(table=="range_straggling")get_spline = &get_range_straggling_spline;
+    else if(table=="angular_variance")get_spline = &get_angular_variance_spline;
+    else throw std::invalid_argument("unknown table "+table);
+
+    auto dp = get_shared_data(p, m, c);
+    py::capsule owner = datapoint_owner(dp);
+    spline_type spline = get_spline(*dp);
+    const auto &ss = spline.coefficients();
+#ifdef STORE_SPLINES
+    py::handle coefficients_owner = owner;
+#else
+    py::handle coefficients_owner; // spline is temporary, coefficients are copied
+#endif
+    py::dict d;
+    d["x"] = get_energy_table();
+    d["y"] = readonly_view(ss.m_y, ss.N, owner);
+    d["a"] = readonly_view(ss.m_a.data(), ss.N, coefficients_owner);
+    d["b"] = readonly_view(ss.m_b.data(), ss.N, coefficients_owner);
+    d["c"] = readonly_view(ss.m_c.data(), ss.N, coefficients_owner);
+    d["c0"] = ss.m_c0;
+    return d;
+#endif
+}
+
 Material py_make_material(py::list d, double density=0.0, double thickness=0.0, double ipot=0.0, double mass=0.0){
     Material m;
     if(density>0.0)m.density(density);
@@ -111,6 +169,113 @@ py::dict get_result_dict(const Result& r){
                     return d;
                     }
 
+using darray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+// output array of the same shape as x, the array out is used if provided
+py::array_t<double> output_array(const py::object &out, const darray &x){
+    if(out.is_none()){
+        return py::array_t<double>(std::vector<py::ssize_t>(x.shape(), x.shape()+x.ndim()));
+    }
+    if(!py::isinstance<py::array_t<double, py::array::c_style>>(out)){
+        throw std::invalid_argument("out must be C contiguous float64 array");
+    }
+    auto res = py::reinterpret_borrow<py::array_t<double>>(out);
+    if(res.size() != x.size())throw std::invalid_argument("out must have the same size as the input");
+    if(!res.writeable())throw std::invalid_argument("out must be writeable");
+    return res;
+}
+
+/**
+ * calls f(x, y, n) for the energies T without holding GIL
+ * numpy arrays of float64 are used without copying and the results are returned as numpy array,
+ * other sequences are converted and the result is returned as list
+ */
+template<typename F>
+py::object vectorize(const py::object &T, const py::object &out, F f){
+    if(py::isinstance<py::array>(T)){
+        darray x = darray::ensure(T);
+        if(!x)throw std::invalid_argument("energies must be convertible to float64 array");
+        py::array_t<double> y = output_array(out, x);
+        const double *px = x.data();
+        double *py_ = y.mutable_data();
+        const std::size_t n = x.size();
+        {
+            py::gil_scoped_release release;
+            f(px, py_, n);
+        }
+        return std::move(y);
+    }
+    auto x = T.cast<std::vector<double>>();
+    std::vector<double> y(x.size());
+    {
+        py::gil_scoped_release release;
+        f(x.data(), y.data(), x.size());
+    }
+    return py::cast(y);
+}
+
+// Result fields stored as columns
+constexpr std::pair<const char*, double Result::*> result_fields[] = {
+    {"Ein", &Result::Ein}, {"Eout", &Result::Eout}, {"Eloss", &Result::Eloss},
+    {"range", &Result::range}, {"dEdxi", &Result::dEdxi}, {"dEdxo", &Result::dEdxo},
+    {"sigma_E", &Result::sigma_E}, {"sigma_a", &Result::sigma_a}, {"sigma_r", &Result::sigma_r},
+    {"sigma_x", &Result::sigma_x}, {"cov", &Result::cov}, {"tof", &Result::tof}, {"sp", &Result::sp}
+};
+constexpr std::size_t nresult_fields = sizeof(result_fields)/sizeof(result_fields[0]);
+
+/**
+ * dict of numpy arrays, one for every Result field
+ * the arrays are allocated with GIL, set() can be called without GIL
+ */
+class ResultColumns{
+    public:
+    explicit ResultColumns(const std::vector<py::ssize_t> &shape){
+        for(std::size_t k=0;k<nresult_fields;k++){
+            arrays[k] = py::array_t<double>(shape);
+            ptr[k] = arrays[k].mutable_data();
+        }
+    }
+    void set(std::size_t i, const Result &r){
+        for(std::size_t k=0;k<nresult_fields;k++)ptr[k][i] = r.*(result_fields[k].second);
+    }
+    py::dict dict() const {
+        py::dict d;
+        for(std::size_t k=0;k<nresult_fields;k++)d[result_fields[k].first] = arrays[k];
+        return d;
+    }
+    private:
+    std::array<py::array_t<double>, nresult_fields> arrays;
+    std::array<double*, nresult_fields> ptr;
+};
+
+// calculate for all energies of the array, returns dict of Result columns
+py::dict calculate_array(const Projectile &p, const darray &T, const Material &m, const Config &c){
+    ResultColumns res(std::vector<py::ssize_t>(T.shape(), T.shape()+T.ndim()));
+    const double *x = T.data();
+    const std::size_t n = T.size();
+    {
+        py::gil_scoped_release release;
+        auto dp = _shared_storage.Get(p, m, c);
+        for(std::size_t i=0;i<n;i++)res.set(i, calculate(*dp, x[i], m));
+    }
+    return res.dict();
+}
+
+/**
+ * multi-threaded calculation of all projectiles and energies passing through the layers
+ * returns dict of Result columns with shape (number of projectiles, number of energies)
+ */
+py::dict calculate_batch_array(const std::vector<Projectile> &projectiles, const darray &T, const Layers &layers, const Config &c, unsigned int threads){
+    std::vector<double> energies(T.data(), T.data()+T.size());
+    ResultColumns res({static_cast<py::ssize_t>(projectiles.size()), static_cast<py::ssize_t>(energies.size())});
+    {
+        py::gil_scoped_release release;
+        auto r = calculate_batch(projectiles, energies, layers, c, threads);
+        for(std::size_t i=0;i<r.size();i++)res.set(i, r[i]);
+    }
+    return res.dict();
+}
+
 PYBIND11_MODULE(pycatima,m){
      py::class_<Projectile>(m,"Projectile")
              .def(py::init<>(),"constructor")
@@ -155,11 +320,12 @@ PYBIND11_MODULE(pycatima,m){
              .def("thickness_cm",py::overload_cast<double>(&Material::thickness_cm),"set thickness in cm unit")
              .def("I",py::overload_cast<>(&Material::I, py::const_), "get I")
              .def("I",py::overload_cast<double>(&Material::I), "set I")
+             .def("fingerprint",&Material::fingerprint, "fingerprint of the material composition")
              .def("__str__",&material_to_string);
 
      py::class_<Layers>(m,"Layers")
              .def(py::init<>(),"constructor")
-             .def("add",py::overload_cast<Material>(&Layers::add))
+             .def("add",py::overload_cast<const Material&>(&Layers::add))
              .def("add_layers",py::overload_cast<const Layers&>(&Layers::add))
              .def("num",&Layers::num)
              .def("thickness",&Layers::thickness)
@@ -270,6 +436,11 @@ PYBIND11_MODULE(pycatima,m){
             .value("dhighland", scattering_types::dhighland)
             .value("gottschalk", scattering_types::gottschalk)
             .value("atima_scattering", scattering_types::atima_scattering);
+
+    py::enum_<accuracy_types>(m,"accuracy_types")
+            .value("reference", accuracy_types::reference)
+            .value("standard", accuracy_types::standard)
+            .value("fast", accuracy_types::fast);
             
 
     py::enum_<material>(m,"material")
@@ -430,6 +601,7 @@ PYBIND11_MODULE(pycatima,m){
             .def_readwrite("calculation", &Config::calculation)
             .def_readwrite("low_energy", &Config::low_energy)
             .def_readwrite("scattering", &Config::scattering)
+            .def_readwrite("accuracy", &Config::accuracy)
             .def("get",[](const Config &r){
                py::dict d;
                d["z_effective"] = r.z_effective;
@@ -437,6 +609,7 @@ PYBIND11_MODULE(pycatima,m){
                d["calculation"] = r.calculation;
                d["low_energy"] = r.low_energy;
                d["scattering"] = r.scattering;
+               d["accuracy"] = r.accuracy;
                return d;
                })
             .def("__str__",[](const Config &r){
@@ -446,6 +619,7 @@ PYBIND11_MODULE(pycatima,m){
                 s += ", calculation = "+std::to_string(r.calculation);
                 s += ", low_energy = "+std::to_string(r.low_energy);
                 s += ", scattering = "+std::to_string(r.scattering);
+                s += ", accuracy = "+std::to_string(r.accuracy);
                 return s;
             });
 
@@ -455,18 +629,56 @@ PYBIND11_MODULE(pycatima,m){
     m.def("sezi_dedx_e",&sezi_dedx_e, "sezi_dedx_e",  py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
     m.def("calculate",py::overload_cast<Projectile, const Material&, const Config&>(&calculate),"calculate",py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
     m.def("calculate",py::overload_cast<const Projectile&, const Layers&, const Config&>(&calculate),"calculate",py::arg("projectile"), py::arg("layers"), py::arg("config")=default_config);
+    m.def("calculate",&calculate_array,"calculate for numpy array of energies, returns dict of arrays",py::arg("projectile"), py::arg("energy"), py::arg("material"), py::arg("config")=default_config);
+    m.def("calculate_batch",&calculate_batch_array,"multi-threaded calculation of projectiles and energies through layers, returns dict of arrays",py::arg("projectiles"), py::arg("energies"), py::arg("layers"), py::arg("config")=default_config, py::arg("threads")=0);
     m.def("calculate",py::overload_cast<const Projectile&, const Phasespace&, const Layers&, const Config&>(&calculate),"calculate",py::arg("projectile"), py::arg("phasespace"),py::arg("layers"), py::arg("config")=default_config);
     m.def("calculate_layers",py::overload_cast<const Projectile&, const Layers&, const Config&>(&calculate),"calculate_layers",py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
     m.def("dedx_from_range",py::overload_cast<const Projectile&, const Material&, const Config&>(&dedx_from_range),"calculate",py::arg("projectile") ,py::arg("material"), py::arg("config")=default_config);
-    m.def("dedx_from_range",py::overload_cast<const Projectile&, const std::vector<double>&, const Material&, const Config&>(&dedx_from_range),"calculate",py::arg("projectile"), py::arg("energy") ,py::arg("material"), py::arg("config")=default_config);
+    m.def("dedx_from_range",[](const Projectile &p, const py::object &T, const Material &m, const Config &c, const py::object &out){
+            return vectorize(T, out, [&](const double *x, double *y, std::size_t n){
+                auto dp = _shared_storage.Get(p, m, c);
+                spline_type range_spline = get_range_spline(*dp);
+                for(std::size_t i=0;i<n;i++)y[i] = (x[i]<Ezero)?0.0:p.A/range_spline.derivative(x[i]);
+                });
+        },"dedx from range for energies",py::arg("projectile"), py::arg("energy") ,py::arg("material"), py::arg("config")=default_config, py::arg("out")=py::none());
     m.def("dedx",py::overload_cast<const Projectile&, const Material&, const Config&>(&dedx), "dedx",py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
+    m.def("dedx",[](const Projectile &p, const py::object &T, const Material &m, const Config &c, const py::object &out){
+            return vectorize(T, out, [&](const double *x, double *y, std::size_t n){dedx(p, m, x, y, n, c);});
+        },"dedx for energies",py::arg("projectile"), py::arg("energy"), py::arg("material"), py::arg("config")=default_config, py::arg("out")=py::none());
+    m.def("domega2dx",[](const Projectile &p, const py::object &T, const Material &m, const Config &c, const py::object &out){
+            return vectorize(T, out, [&](const double *x, double *y, std::size_t n){domega2dx(p, m, x, y, n, c);});
+        },"energy loss straggling variance for energies",py::arg("projectile"), py::arg("energy"), py::arg("material"), py::arg("config")=default_config, py::arg("out")=py::none());
     m.def("range",py::overload_cast<const Projectile&, const Material&, const Config&>(&range), "range",py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
-    m.def("energy_out",py::overload_cast<const Projectile&, const std::vector<double>&, const Material&, const Config&>(&energy_out),"energy_out",py::arg("projectile"), py::arg("energy") ,py::arg("material"), py::arg("config")=default_config);
+    m.def("range",[](const Projectile &p, const py::object &T, const Material &m, const Config &c, const py::object &out){
+            return vectorize(T, out, [&](const double *x, double *y, std::size_t n){
+                auto dp = _shared_storage.Get(p, m, c);
+                spline_type range_spline = get_range_spline(*dp);
+                for(std::size_t i=0;i<n;i++)y[i] = range_spline(x[i]);
+                });
+        },"range for energies",py::arg("projectile"), py::arg("energy"), py::arg("material"), py::arg("config")=default_config, py::arg("out")=py::none());
+    m.def("energy_out",[](const Projectile &p, const py::object &T, const Material &m, const Config &c, const py::object &out){
+            return vectorize(T, out, [&](const double *x, double *y, std::size_t n){
+                auto dp = _shared_storage.Get(p, m, c);
+                spline_type range_spline = get_range_spline(*dp);
+                for(std::size_t i=0;i<n;i++)y[i] = (x[i]<Ezero)?0.0:energy_out(x[i], m.thickness(), range_spline);
+                });
+        },"energy_out for energies",py::arg("projectile"), py::arg("energy") ,py::arg("material"), py::arg("config")=default_config, py::arg("out")=py::none());
     m.def("energy_out",py::overload_cast<const Projectile&, const Material&, const Config&>(&energy_out),"energy_out",py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
-    m.def("lindhard",&bethek_lindhard);
-    m.def("lindhard_X",&bethek_lindhard_X);
+    m.def("energy_in",[](const Projectile &p, const py::object &T, const Material &m, const Config &c, const py::object &out){
+            return vectorize(T, out, [&](const double *x, double *y, std::size_t n){
+                auto dp = _shared_storage.Get(p, m, c);
+                spline_type range_spline = get_range_spline(*dp);
+                for(std::size_t i=0;i<n;i++)y[i] = energy_in(x[i], m.thickness(), range_spline);
+                });
+        },"energy_in for energies",py::arg("projectile"), py::arg("energy") ,py::arg("material"), py::arg("config")=default_config, py::arg("out")=py::none());
+    m.def("energy_in",py::overload_cast<const Projectile&, const Material&, const Config&>(&energy_in),"energy_in",py::arg("projectile"), py::arg("material"), py::arg("config")=default_config);
+    m.def("lindhard",py::overload_cast<const Projectile&>(&bethek_lindhard));
+    m.def("lindhard_X",py::overload_cast<const Projectile&>(&bethek_lindhard_X));
     m.def("get_material",py::overload_cast<int>(&get_material));
-    m.def("get_data",py::overload_cast<Projectile&, const Material&, const Config&>(get_data),"list of data",py::arg("projectile"),py::arg("material"),py::arg("config")=default_config);
+    m.def("get_material",[](const std::string &name){return get_material(material_id(name.c_str()));});
+    m.def("material_id",[](const std::string &name){return material_id(name.c_str());});
+    m.def("get_data",&get_data,"list of read-only range, range straggling and angular variance tables",py::arg("projectile"),py::arg("material"),py::arg("config")=default_config);
+    m.def("get_spline_coefficients",&get_spline_coefficients,"dict of read-only spline coefficients of the DataPoint table",py::arg("projectile"),py::arg("material"),py::arg("table")="range",py::arg("config")=default_config);
     m.def("w_magnification",[](Projectile& p, double energy, const Material& m, const Config& c){
         py::list l;
         auto r = w_magnification(p, energy, m, c);
@@ -476,7 +688,7 @@ PYBIND11_MODULE(pycatima,m){
     });
     m.def("save_mocadi", &save_mocadi,py::arg("filename"),py::arg("projectile"),py::arg("layers"),py::arg("psx")=Phasespace(), py::arg("psy")=Phasespace());
     m.def("catima_info",&catima_info);
-    m.def("storage_info",&storage_info);
+    m.def("storage_info",&storage_info,"list of cached DataPoints, the storage item is \"shared\" for get_data and the array views, \"single\" for the single-threaded calculations");
     m.def("get_energy_table",&get_energy_table);
     m.def("energy_table",[](int i){return energy_table(i);});
     m.def("z_effective",&z_effective);
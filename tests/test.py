@@ -221,6 +221,52 @@ class TestStructures(unittest.TestCase):
             r = catima.dedx_from_range(p(e), graphite)
             self.assertAlmostEqual(res2[i], r, 0.1)
 
+    def test_numpy_arrays(self):
+        import numpy as np
+        graphite = catima.get_material(6)
+        graphite.thickness(0.5)
+        p = catima.Projectile(12,6)
+        energies = np.array([100.,500.,1000.])
+        eout = catima.energy_out(p, energies, graphite)
+        self.assertIsInstance(eout, np.ndarray)
+        self.assertEqual(eout.shape, energies.shape)
+        for i,e in enumerate(energies):
+            self.assertAlmostEqual(eout[i], catima.calculate(p(e),graphite).Eout, 6)
+
+        out = np.zeros(3)
+        r = catima.dedx_from_range(p, energies, graphite, out=out)
+        self.assertTrue(np.shares_memory(r, out))
+        self.assertAlmostEqual(out[1], catima.dedx_from_range(p(500), graphite), 6)
+        ein = catima.energy_in(p, eout, graphite)
+        self.assertAlmostEqual(ein[2], 1000., 3)
+        with self.assertRaises(ValueError):
+            catima.energy_out(p, energies, graphite, out=np.zeros(2))
+
+        res = catima.calculate(p, energies, graphite)
+        self.assertEqual(res["Eout"].shape, energies.shape)
+        self.assertAlmostEqual(res["Eout"][2], eout[2], 6)
+        self.assertAlmostEqual(res["sigma_a"][0], catima.calculate(p(100),graphite).sigma_a, 9)
+        self.assertAlmostEqual(catima.range(p, energies, graphite)[1], catima.range(p(500), graphite), 6)
+
+    def test_calculate_batch(self):
+        import numpy as np
+        layers = catima.Layers()
+        water = catima.get_material(catima.material.Water)
+        water.thickness(0.5)
+        graphite = catima.get_material(6)
+        graphite.thickness(1.0)
+        layers.add(water)
+        layers.add(graphite)
+        projectiles = [catima.Projectile(12,6), catima.Projectile(1,1)]
+        energies = np.array([200., 500., 1000.])
+        res = catima.calculate_batch(projectiles, energies, layers, threads=2)
+        self.assertEqual(res["Eout"].shape, (2,3))
+        for i,p in enumerate(projectiles):
+            for k,e in enumerate(energies):
+                r = catima.calculate(p(e), layers)
+                self.assertAlmostEqual(res["Eout"][i,k], r.total_result.Eout, 6)
+                self.assertAlmostEqual(res["sigma_E"][i,k], r.total_result.sigma_E, 9)
+
     def test_layer_calculation(self):
         p = catima.Projectile(12,6)
         water = catima.get_material(catima.material.Water)
@@ -287,6 +333,26 @@ class TestStructures(unittest.TestCase):
         self.assertAlmostEqual(catima.range(p,water),data[0][401],6)
         #self.assertAlmostEqual(catima.domega2de(p,water),data[1][401],6)
         
+    def test_table_views(self):
+        import numpy as np
+        p = catima.Projectile(12,6)
+        water = catima.get_material(catima.material.Water)
+        data = catima.get_data(p, water)
+        et = catima.get_energy_table()
+        self.assertIsInstance(data[0], np.ndarray)
+        self.assertFalse(data[0].flags.writeable)
+        self.assertFalse(data[0].flags.owndata)
+        self.assertEqual(len(et), catima.max_datapoints)
+
+        s = catima.get_spline_coefficients(p, water, "range")
+        self.assertTrue(np.shares_memory(s["y"], data[0]))
+        i = 300
+        h = 0.5*(et[i+1]-et[i])
+        y = ((s["a"][i]*h + s["b"][i])*h + s["c"][i])*h + s["y"][i]
+        self.assertAlmostEqual(y, catima.calculate(p(et[i]+h), water).range, 6)
+        with self.assertRaises(ValueError):
+            catima.get_spline_coefficients(p, water, "unknown")
+
     def test_python_storage_access(self):
         
         p = catima.Projectile(12,6)
@@ -297,6 +363,8 @@ class TestStructures(unittest.TestCase):
         data = catima.get_data(p, water)
         self.assertEqual(catima.max_storage_data,60) # assuming 60, this has to be changed manually
         r = catima.storage_info()
+        shared = [d for d in r if d["storage"] == "shared"]
+        self.assertTrue(any(d["projectile"] == [12.0, 6.0] for d in shared))
         
         #self.assertAlmostEqual(catima.da2de(p,water,et[100]),data[2][100],6)
         #self.assertAlmostEqual(catima.da2de(p,water,et[400]),data[2][400],6)
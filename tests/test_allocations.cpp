@@ -0,0 +1,89 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "catima/catima.h"
+#include "catima/batch.h"
+#include "catima/material_database.h"
+
+// every heap allocation of the program is counted
+namespace{
+    std::atomic<long> allocations{0};
+}
+
+void* operator new(std::size_t size){
+    allocations++;
+    if(void *p = std::malloc(size?size:1))return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {std::free(p);}
+void operator delete(void *p, std::size_t) noexcept {std::free(p);}
+
+// returns number of allocations done by f
+template<typename F>
+long count_allocations(F&& f){
+    long start = allocations;
+    f();
+    return allocations - start;
+}
+
+using namespace catima;
+
+TEST_CASE("warm calculate does not allocate"){
+    Projectile p(12,6);
+    Material water = get_material(material::Water);
+    water.thickness(1.0);
+    Result r = calculate(p(500),water);
+    CHECK(count_allocations([&]{r = calculate(p(500),water);}) == 0);
+    CHECK(count_allocations([&]{r = calculate(p(300),water);}) == 0);
+    CHECK(count_allocations([&]{Material m = water; m.thickness(2.0);}) == 0);
+    CHECK(count_allocations([&]{angular_straggling_from_E(p(500),400,water);}) == 0);
+    CHECK(count_allocations([&]{w_magnification(p,500,water);}) == 0);
+    CHECK(r.Eout>0);
+}
+
+TEST_CASE("caller provided output arrays do not allocate"){
+    Projectile p(1,1);
+    Material graphite = get_material(6);
+    graphite.thickness(0.5);
+    const double T[4] = {50,100,200,1000};
+    double res[4];
+    energy_out(p,graphite,T,res,4);
+    CHECK(count_allocations([&]{energy_out(p,graphite,T,res,4);}) == 0);
+    CHECK(count_allocations([&]{energy_in(p,graphite,T,res,4);}) == 0);
+    CHECK(count_allocations([&]{dedx_from_range(p,graphite,T,res,4);}) == 0);
+    CHECK(count_allocations([&]{dedx(p,graphite,T,res,4);}) == 0);
+    CHECK(count_allocations([&]{energy_out(p,std::vector<double>(T,T+4),graphite);}) > 0); // the hook works
+
+    dedx_from_range(p,graphite,T,res,4);
+    auto dv = dedx_from_range(p,std::vector<double>(T,T+4),graphite);
+    for(int i=0;i<4;i++)CHECK(res[i] == dv[i]);
+}
+
+TEST_CASE("warm layers calculation does not allocate"){
+    Projectile p(12,6,6,600);
+    Layers layers;
+    layers.add(get_material(material::Water).thickness(0.5));
+    layers.add(get_material(6).thickness(1.0));
+    layers.add(get_material(material::Kapton).thickness(0.2));
+    MultiResult res;
+    calculate(p,{},layers,res);
+    MultiResult res2 = calculate(p,layers);
+    CHECK(count_allocations([&]{calculate(p,{},layers,res);}) == 0);
+    REQUIRE(res.results.size() == 3);
+    CHECK(res.total_result.Eout == res2.total_result.Eout);
+    CHECK(res.results[2].Eout == res2.results[2].Eout);
+}
+
+TEST_CASE("warm batch calculation does not allocate"){
+    std::vector<Projectile> projectiles{Projectile(12,6), Projectile(1,1)};
+    std::vector<Material> materials{get_material(material::Water).thickness(0.5), get_material(6).thickness(0.1)};
+    std::vector<double> energies{100,200,500};
+    std::vector<Result> res(projectiles.size()*materials.size()*energies.size());
+    ThreadPool pool(2);
+    calculate_batch(projectiles, materials, energies, res.data(), default_config, pool);
+    CHECK(count_allocations([&]{calculate_batch(projectiles, materials, energies, res.data(), default_config, pool);}) == 0);
+    auto ref = calculate(projectiles[1](500), materials[1]);
+    CHECK(res[batch_index(1,1,2,2,3)].Eout == ref.Eout);
+}
@@ -0,0 +1,159 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_SUPER_FAST_ASSERTS
+#include "doctest.h"
+#include <math.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include "testutils.h"
+#include "catima/catima.h"
+#include "catima/batch.h"
+#include "catima/thread_pool.h"
+#include "catima/material_database.h"
+using namespace std;
+
+    TEST_CASE("thread pool"){
+      catima::ThreadPool pool(4);
+      CHECK(pool.size()==4);
+      std::vector<int> v(10000,0);
+      pool.parallel_for(v.size(), [&](std::size_t i){v[i]+=i%7;});
+      long sum = 0;
+      for(std::size_t i=0;i<v.size();i++){
+          CHECK(v[i]==i%7);
+          sum+=v[i];
+      }
+      CHECK(sum>0);
+
+      // nested loop runs serially
+      std::atomic<long> count{0};
+      pool.parallel_for(50, [&](std::size_t){
+          pool.parallel_for(100, [&](std::size_t){count++;});
+          });
+      CHECK(count==5000);
+
+      CHECK_THROWS_AS(pool.parallel_for(1000, [](std::size_t i){if(i==777)throw std::runtime_error("error");}), std::runtime_error);
+      // pool still usable after exception
+      count = 0;
+      pool.parallel_for(1000, [&](std::size_t){count++;});
+      CHECK(count==1000);
+
+      // concurrent callers from outside share the pool
+      count = 0;
+      std::vector<std::thread> callers;
+      for(int t=0;t<4;t++){
+          callers.emplace_back([&]{
+              for(int k=0;k<20;k++)pool.parallel_for(500, [&](std::size_t){count++;});
+              });
+      }
+      for(auto &t:callers)t.join();
+      CHECK(count==4*20*500);
+    }
+
+    TEST_CASE("shared storage"){
+      catima::Projectile p{12,6,6,1000};
+      catima::Material water = catima::get_material(catima::material::Water);
+      catima::SharedData storage(2);
+      auto d1 = storage.Get(p,water);
+      auto d2 = storage.Get(p,water);
+      CHECK(d1==d2);
+      CHECK(storage.GetN()==1);
+      CHECK(storage.GetStored().size()==1);
+      CHECK(storage.GetStored()[0]==d1);
+      CHECK(*d1 == catima::get_data(p,water));
+      storage.Get(p,catima::get_material(6));
+      storage.Get(p,catima::get_material(13));
+      CHECK(storage.GetN()==2);
+      // replaced DataPoint is still valid
+      CHECK(d1->range.size()==catima::max_datapoints);
+      storage.Reset();
+      CHECK(storage.GetN()==0);
+    }
+
+    TEST_CASE("grid batch"){
+      std::vector<catima::Projectile> projectiles{{12,6},{238,92},{1,1}};
+      std::vector<catima::Material> materials{catima::get_material(6), catima::get_material(catima::material::Water)};
+      materials[0].thickness(0.5);
+      materials[1].thickness(1.0);
+      std::vector<double> energies{0.5, 50, 100, 500, 1000};
+
+      auto res = catima::calculate_batch(projectiles, materials, energies, catima::default_config, 3);
+      CHECK(res.size()==projectiles.size()*materials.size()*energies.size());
+      for(std::size_t ip=0;ip<projectiles.size();ip++)
+      for(std::size_t im=0;im<materials.size();im++)
+      for(std::size_t ie=0;ie<energies.size();ie++){
+          auto p = projectiles[ip];
+          auto r = catima::calculate(p(energies[ie]), materials[im]);
+          auto &b = res[catima::batch_index(ip,im,ie,materials.size(),energies.size())];
+          CHECK(b.Ein == r.Ein);
+          CHECK(b.Eout == r.Eout);
+          CHECK(b.range == r.range);
+          CHECK(b.sigma_E == r.sigma_E);
+          CHECK(b.sigma_a == r.sigma_a);
+          CHECK(b.sigma_r == r.sigma_r);
+          CHECK(b.tof == r.tof);
+          CHECK(b.sp == r.sp);
+      }
+
+      auto res2 = catima::calculate_batch(projectiles, materials, energies);
+      for(std::size_t i=0;i<res.size();i++){
+          CHECK(res2[i].Eout == res[i].Eout);
+      }
+
+      CHECK(catima::calculate_batch(projectiles, {}, energies).empty());
+
+      // the batch does not keep the DataPoints alive after it returns
+      auto dp = catima::_shared_storage.Get(projectiles[0], materials[0]);
+      CHECK(dp.use_count()==2); // shared storage and dp
+    }
+
+    TEST_CASE("job batch"){
+      catima::Projectile p1{12,6};
+      catima::Projectile p2{4,2};
+      catima::Material graphite = catima::get_material(6);
+      graphite.thickness(1.0);
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness(0.3);
+      catima::Config c2;
+      c2.z_effective = catima::z_eff_type::winger;
+
+      std::vector<catima::BatchJob> jobs;
+      for(int i=0;i<200;i++){
+          double T = 10.0 + 5*i;
+          jobs.push_back({p1(T), graphite});
+          jobs.push_back({p2(T), water, c2});
+          jobs.push_back({p1(T), water});
+      }
+      auto res = catima::calculate_batch(jobs, 4);
+      CHECK(res.size()==jobs.size());
+      for(std::size_t i=0;i<jobs.size();i++){
+          auto r = catima::calculate(jobs[i].p, jobs[i].m, jobs[i].c);
+          CHECK(res[i].Ein == r.Ein);
+          CHECK(res[i].Eout == r.Eout);
+          CHECK(res[i].sigma_E == r.sigma_E);
+          CHECK(res[i].tof == r.tof);
+      }
+      CHECK(catima::calculate_batch(std::vector<catima::BatchJob>()).empty());
+    }
+
+    TEST_CASE("layers batch"){
+      std::vector<catima::Projectile> projectiles{{12,6},{1,1}};
+      catima::Layers layers;
+      layers.add(catima::get_material(catima::material::Water).thickness(0.5));
+      layers.add(catima::get_material(6).thickness(1.0));
+      std::vector<double> energies{50,200,500,1000};
+
+      auto res = catima::calculate_batch(projectiles, energies, layers, catima::default_config, 3);
+      CHECK(res.size()==projectiles.size()*energies.size());
+      for(std::size_t i=0;i<projectiles.size();i++){
+          for(std::size_t k=0;k<energies.size();k++){
+              auto r = catima::calculate(projectiles[i], energies[k], layers).total_result;
+              const auto &b = res[i*energies.size()+k];
+              CHECK(b.Ein == r.Ein);
+              CHECK(b.Eout == r.Eout);
+              CHECK(b.sigma_E == r.sigma_E);
+              CHECK(b.sigma_a == r.sigma_a);
+              CHECK(b.tof == r.tof);
+          }
+      }
+      CHECK(catima::calculate_batch(projectiles, std::vector<double>(), layers).empty());
+    }
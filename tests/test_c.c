@@ -37,5 +37,39 @@ int main()
     dif = r.Eloss - 80.75;
     expect(fabs(dif)<1,"Eloss");
 
+    CatimaContext *ctx = catima_context_new(NULL);
+    CatimaMaterial *mat = catima_material_new(12,6,1.0,2.0);
+    CatimaPrepared *prep = catima_prepare(ctx,12,6,mat);
+    expect(ctx && mat && prep,"handles");
+    r = catima_calculate(12,6,500,12,6,1.0,2.0);
+    CatimaResult rp = catima_prepared_calculate(prep,500);
+    expect(rp.Eout == r.Eout && rp.sigma_a == r.sigma_a && rp.tof == r.tof,"prepared calculate");
+
+    double T[3] = {100, 500, 1000};
+    double eout[3], rng[3];
+    CatimaResult res[3];
+    catima_prepared_calculate_n(prep,T,res,3);
+    catima_prepared_Eout_n(prep,T,eout,3);
+    catima_prepared_range_n(prep,T,rng,3);
+    int ok = 1;
+    for(int i=0;i<3;i++){
+        r = catima_calculate(12,6,T[i],12,6,1.0,2.0);
+        ok = ok && res[i].Eout == r.Eout && fabs(eout[i]-r.Eout)<1e-6 && fabs(rng[i]-r.range)<1e-6;
+    }
+    expect(ok,"prepared batch");
+    catima_prepared_free(prep);
+    catima_material_free(mat);
+
+    mat = catima_material_new(0,0,0.0,1.0);
+    expect(catima_prepare(ctx,12,6,mat) == NULL,"empty material");
+    catima_material_add_element(mat,1,1,2);
+    catima_material_add_element(mat,16,8,1);
+    catima_material_set_thickness(mat,1.0);
+    prep = catima_prepare(ctx,12,6,mat);
+    expect(prep != NULL,"compound material");
+    catima_prepared_free(prep);
+    catima_material_free(mat);
+    catima_context_free(ctx);
+
     return 1.0;
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include <math.h>
 #include "catima/catima.h"
 #include "catima/calculations.h"
+#include "catima/kernels.h"
+#include "catima/srim.h"
+#include "catima/constants.h"
+#include "catima/integrator.h"
 
 using namespace std;
 
@@ -50,6 +54,24 @@ using namespace std;
         p.T = 30;
         CHECK( catima::sezi_dedx_e(p,carbon) == approx(16.8,1));        
     }
+    TEST_CASE("srim tables"){
+        for(int pz:{1, 2, 6, 16, 40, 92}){
+            for(int tz:{1, 6, 29, 82, 91}){
+                for(bool v95:{false, true}){
+                    for(int i=0;i<300;i++){
+                        double e = pow(10.0, -3.0 + 4.4*(i+0.37)/300.0);
+                        double direct = catima::srim_dedx_e(pz, tz, e, v95);
+                        CHECK(catima::srim_dedx_e_tabulated(pz, tz, e, v95) == approx(direct).R(1e-4));
+                    }
+                }
+            }
+        }
+        // discontinuity of the heavy ion low velocity branch is evaluated directly
+        CHECK(catima::srim_dedx_e_tabulated(40, 91, 0.00516) == approx(catima::srim_dedx_e(40, 91, 0.00516)).R(1e-12));
+        // outside of the tables
+        CHECK(catima::srim_dedx_e_tabulated(6, 6, 50.0) == catima::srim_dedx_e(6, 6, 50.0));
+        CHECK(catima::srim_dedx_e_tabulated(6, 100, 1.0) == catima::srim_dedx_e(6, 100, 1.0));
+    }
     TEST_CASE("dedx, low energy, from sezi"){
         catima::Projectile p{4,2,2,1};
         auto carbon = catima::get_material(6);
@@ -111,6 +133,38 @@ using namespace std;
         for(double e:{2000,20000,200000, 9000000, 50000000})
             CHECK(catima::precalculated_lindhard_X(p(e)) >= 0.0);
     }
+    TEST_CASE("LS check: projectiles outside of generated tables"){
+        catima::Projectile p{238,92,92,1};
+        for(double e:{93.1494, 380.9932, 2640.032566}){
+            CHECK(catima::bethek_lindhard(p(e), 1e-4) == approx(catima::bethek_lindhard(p(e)), 2e-4));
+            CHECK(catima::bethek_lindhard_X(p(e), 1e-4) == approx(catima::bethek_lindhard_X(p(e)), 4e-4));
+        }
+
+        catima::Projectile sh{295,118};
+        for(double e:{5.0, 100.0, 1000.0}){
+            CHECK(catima::precalculated_lindhard(sh(e)) == approx(catima::bethek_lindhard(sh(e)), 0.01));
+            CHECK(catima::precalculated_lindhard_X(sh(e)) == approx(catima::bethek_lindhard_X(sh(e))).R(0.01));
+        }
+
+        // Z*alpha above 1 uses the exact correction of Z=137
+        catima::Projectile superheavy{400,150};
+        CHECK(std::isfinite(catima::precalculated_lindhard(superheavy(1000.0))));
+        CHECK(std::isfinite(catima::precalculated_lindhard_X(superheavy(1000.0))));
+
+        // masses within the window are interpolated from the generated coefficients
+        for(auto isotope:{catima::Projectile{132,50}, catima::Projectile{12,4}, catima::Projectile{100,50}}){
+            for(double e:{10.0, 500.0, 5000.0}){
+                CHECK(catima::precalculated_lindhard(isotope(e)) == approx(catima::bethek_lindhard(isotope(e)), 0.01));
+                CHECK(catima::precalculated_lindhard_X(isotope(e)) == approx(catima::bethek_lindhard_X(isotope(e))).R(0.01));
+            }
+        }
+
+        catima::Projectile exotic{8,6};
+        for(double e:{10.0, 500.0}){
+            CHECK(catima::precalculated_lindhard(exotic(e)) == approx(catima::bethek_lindhard(exotic(e)), 1e-3));
+            CHECK(catima::precalculated_lindhard_X(exotic(e)) == approx(catima::bethek_lindhard_X(exotic(e))).R(0.01));
+        }
+    }
     TEST_CASE("ultrarelativistic corrections"){
         catima::Projectile p{238,92};
         catima::Target t{27,13};
@@ -540,6 +594,222 @@ using namespace std;
         CHECK(z_eff_atima14(92,1900,13) == z_effective(p_u(1900.),t,c));
         #endif
     }
+    TEST_CASE("z_eff tables"){
+        using namespace catima;
+        for(unsigned char m:{z_eff_type::pierce_blann, z_eff_type::anthony_landorf, z_eff_type::hubert,
+                             z_eff_type::winger, z_eff_type::schiwietz}){
+            Config c;
+            c.z_effective = m;
+            for(int pz:{1, 6, 28, 54, 92}){
+                for(int tz:{1, 6, 13, 29, 82}){
+                    Projectile p(2.0*pz, pz);
+                    Target t{2.0*tz, tz};
+                    for(int i=0;i<200;i++){
+                        double e = pow(10.0, -3.0 + 10.0*(i+0.37)/200.0);
+                        double z = z_effective(p(e), t, c);
+                        CHECK(z_eff_tabulated(m, pz, e, tz) == approx(z, zeff_table_tolerance*std::abs(z) + 1e-12));
+                    }
+                }
+            }
+        }
+        // non integer Z is calculated directly
+        CHECK(z_eff_tabulated(z_eff_type::winger, 6.5, 10.0, 6) == z_eff_Winger(6.5, beta_from_T(10.0), 6));
+    }
+    TEST_CASE("config policy"){
+        using namespace catima;
+        Projectile p(12,6);
+        Material water({{1,1,2},{16,8,1}});
+        Config c;
+        for(unsigned char z:{z_eff_type::none, z_eff_type::pierce_blann, z_eff_type::anthony_landorf,
+                             z_eff_type::hubert, z_eff_type::winger, z_eff_type::schiwietz}){
+            for(unsigned char calc:{omega_types::atima, omega_types::bohr}){
+                for(unsigned char cor:{0, corrections::no_barkas|corrections::no_shell_correction}){
+                    c.z_effective = z;
+                    c.calculation = calc;
+                    c.corrections = cor;
+                    bool is_static = dispatch_config(c, [](auto policy){
+                        return !std::is_same<decltype(policy), RuntimePolicy>::value;
+                        });
+                    CHECK(is_static == (cor==0));
+                    for(double T:{5.0, 20.0, 100.0, 1000.0}){
+                        double d = kernels::dedx<RuntimePolicy>(p(T), water, c);
+                        CHECK(dedx(p(T), water, c) == approx(d).R(1e-14));
+                        double o = kernels::domega2dx<RuntimePolicy>(p(T), water, c);
+                        CHECK(domega2dx(p(T), water, c) == approx(o).R(1e-14));
+                    }
+                }
+            }
+        }
+        // compile time policy ignores Config values
+        c.z_effective = z_eff_type::winger;
+        using PB = ConfigPolicy<z_eff_type::pierce_blann, 0, omega_types::bohr>;
+        Target t{12.0107, 6};
+        CHECK(kernels::z_effective<PB>(p(100), t, c) == z_eff_Pierce_Blann(6, beta_from_T(100)));
+    }
+    TEST_CASE("batch kernels"){
+        using namespace catima;
+        Material water({{1,1,2},{16,8,1}});
+        Material lead = get_material(82);
+        std::vector<double> energies{0.0, 1.0, 5.0, 10.0, 15.0, 29.9, 30.0, 50.0, 100.0, 1000.0, 60000.0};
+        for(int i=0;i<100;i++)energies.push_back(1.0+i*13.7);
+        for(auto p:{Projectile(1,1), Projectile(12,6), Projectile(238,92)}){
+            for(const Material &m:{water, lead}){
+                std::vector<double> nuc(energies.size());
+                dedx_n(p, m, energies.data(), nuc.data(), energies.size());
+                auto d = dedx(p, energies, m);
+                auto o = domega2dx(p, energies, m);
+                CHECK(nuc[0] == 0.0);
+                CHECK(d[0] == 0.0);
+                for(std::size_t i=1;i<energies.size();i++){
+                    CHECK(nuc[i] == approx(dedx_n(p(energies[i]), m)).R(1e-12));
+                    CHECK(d[i] == approx(dedx(p(energies[i]), m)).R(1e-12));
+                    CHECK(o[i] == approx(domega2dx(p(energies[i]), m)).R(1e-12));
+                }
+            }
+        }
+    }
+    TEST_CASE("batch integration"){
+        integrators::GaussLegendreIntegration<8> gl8;
+        integrators::GaussLegendreIntegration<3> gl3;
+        auto f = [](double x){return exp(-x)*x*x;};
+        int calls = 0;
+        auto fb = [&](const double *x, double *y, std::size_t n){
+            calls++;
+            for(std::size_t i=0;i<n;i++)y[i] = exp(-x[i])*x[i]*x[i];
+            };
+        CHECK(gl8.integrate_batch(fb, 0.5, 3.0) == approx(gl8.integrate(f, 0.5, 3.0)).R(1e-14));
+        CHECK(gl3.integrate_batch(fb, 0.5, 3.0) == approx(gl3.integrate(f, 0.5, 3.0)).R(1e-14));
+        CHECK(calls == 2);
+
+        std::vector<double> a, b;
+        for(int i=0;i<1000;i++){
+            a.push_back(0.01*i);
+            b.push_back(0.01*i + 0.5);
+        }
+        std::vector<double> res(a.size());
+        calls = 0;
+        gl8.integrate_batch(fb, a.data(), b.data(), res.data(), a.size());
+        CHECK(calls < 20);
+        for(std::size_t i=0;i<a.size();i++){
+            CHECK(res[i] == approx(gl8.integrate(f, a[i], b[i])).R(1e-14));
+        }
+
+        catima::Projectile p{12,6};
+        catima::Material water = catima::get_material(catima::material::Water);
+        water.thickness(1.0);
+        auto ftof = [&](double x){return 1.0/(catima::dedx(p(x),water)*catima::beta_from_T(x));};
+        double tof = catima::integrator.integrate(ftof, 100.0, 200.0)*10.0*p.A/(catima::c_light*water.density());
+        CHECK(catima::calculate_tof_from_E(p(200), 100.0, water) == approx(tof).R(1e-10));
+    }
+    TEST_CASE("adaptive integration workspace"){
+        using GK = integrators::GaussKronrodIntegration<21>;
+        integrators::GKWorkspace w(50);
+        int calls = 0;
+        auto f = [&](double x){calls++; return sqrt(x);};
+        auto r = GK::integrate_workspace(f, 0.0, 1.0, w, 1e-10, 0.0);
+        CHECK(r.converged);
+        CHECK(r.neval == calls);
+        CHECK(r.nintervals == (int)w.size());
+        CHECK(r.value == approx(2.0/3.0, 1e-10));
+        CHECK(std::abs(r.value - 2.0/3.0) <= r.error);
+
+        // budget of evaluations
+        calls = 0;
+        r = GK::integrate_workspace(f, 0.0, 1.0, w, 1e-14, 0.0, 100);
+        CHECK_FALSE(r.converged);
+        CHECK(r.neval <= 100);
+        CHECK(calls == r.neval);
+        CHECK(r.value == approx(2.0/3.0, 1e-4));
+
+        // workspace limit
+        integrators::GKWorkspace small(3);
+        r = GK::integrate_workspace(f, 0.0, 1.0, small, 1e-14, 0.0);
+        CHECK_FALSE(r.converged);
+        CHECK(r.nintervals == 3);
+
+        // smooth function needs single interval
+        auto g = [](double x){return exp(-x)*x*x;};
+        r = GK::integrate_workspace(g, 0.5, 3.0, w);
+        CHECK(r.converged);
+        CHECK(r.nintervals == 1);
+        CHECK(r.neval == 21);
+
+        std::vector<std::pair<double,double>> intervals{{0.0,0.25},{0.25,0.5},{0.5,1.0}};
+        r = GK::integrate_workspace(f, intervals.data(), intervals.size(), w, 1e-10, 0.0);
+        CHECK(r.value == approx(2.0/3.0, 1e-10));
+        CHECK(GK::integrate_intervals(f, intervals, 1e-8, 0.0) == approx(2.0/3.0, 1e-8));
+        CHECK(GK::integrate(f, 0.0, 1.0, 1e-8, 0.0, 4) == approx(2.0/3.0, 1e-8));
+        CHECK(catima::integrator_adaptive.integrate(g, 0.0, 10.0) == approx(2.0 - 122.0*exp(-10.0), 1e-3));
+
+        // nested integration uses own workspace, int_0^1 int_0^1 sqrt(x)*exp(-x*y) dy dx
+        auto outer = [&](double x){
+            auto inner = [x](double y){return sqrt(x)*exp(-x*y);};
+            return catima::integrator_adaptive.integrate(inner, 0.0, 1.0, 1e-12, 1e-10);
+            };
+        auto exact = [](double x){return (x>0)?(1.0-exp(-x))/sqrt(x):0.0;};
+        double nested = catima::integrator_adaptive.integrate(outer, 0.0, 1.0, 1e-10, 1e-10);
+        CHECK(nested == approx(GK::integrate(exact, 0.0, 1.0, 1e-12, 1e-10), 1e-8));
+    }
+    TEST_CASE("accuracy tiers"){
+        using namespace catima;
+        Config reference;
+        Config standard;
+        standard.accuracy = accuracy_types::standard;
+        Config fast;
+        fast.accuracy = accuracy_types::fast;
+        CHECK(!(reference==standard));
+        for(auto p:{Projectile(1,1), Projectile(12,6), Projectile(238,92)}){
+            for(int mz:{1, 6, 82}){
+                Material m = get_material(mz);
+                auto d0 = calculate_DataPoint(p, m, reference);
+                auto d1 = calculate_DataPoint(p, m, standard);
+                auto d2 = calculate_DataPoint(p, m, fast);
+                for(int i=1;i<max_datapoints;i++){
+                    CHECK(d1.range[i] == approx(d0.range[i]).R(1e-5));
+                    CHECK(d1.angular_variance[i] == approx(d0.angular_variance[i]).R(1e-5));
+                    CHECK(d1.range_straggling[i] == approx(d0.range_straggling[i]).R(1e-5));
+                    CHECK(d2.range[i] == approx(d0.range[i]).R(1e-3));
+                    CHECK(d2.angular_variance[i] == approx(d0.angular_variance[i]).R(1e-3));
+                    CHECK(d2.range_straggling[i] == approx(d0.range_straggling[i]).R(1e-3));
+                }
+            }
+        }
+        Projectile p{12,6,6,500};
+        Material water = get_material(material::Water);
+        water.thickness(1.0);
+        CHECK(calculate(p,water,fast).Eout == approx(calculate(p,water).Eout).R(1e-4));
+    }
+    TEST_CASE("compound tables from element tables"){
+        using namespace catima;
+        Config c;
+        for(auto p:{Projectile(1,1), Projectile(238,92)}){
+            for(auto mat:{material::Water, material::Kapton, material::Air}){
+                Material m = get_material(mat);
+                auto d = calculate_DataPoint(p, m, c);
+                auto fr = [&](double x){return 1.0/dedx(p(x),m,c);};
+                auto fa = [&](double x){return da2dx(p(x),m,c)/dedx(p(x),m,c);};
+                auto fo = [&](double x){return domega2dx(p(x),m,c)/pow(dedx(p(x),m,c),3);};
+                double r = 0.0, a = 0.0, o = 0.0;
+                for(int i=1;i<max_datapoints;i++){
+                    r += p.A*integrator.integrate(fr, energy_table(i-1), energy_table(i));
+                    a += p.A*integrator.integrate(fa, energy_table(i-1), energy_table(i));
+                    o += p.A*integrator.integrate(fo, energy_table(i-1), energy_table(i));
+                    CHECK(d.range[i] == approx(r).R(1e-10));
+                    CHECK(d.angular_variance[i] == approx(a).R(1e-10));
+                    CHECK(d.range_straggling[i] == approx(o).R(1e-10));
+                }
+            }
+        }
+        // custom ionisation potential is not additive
+        Projectile p(12,6);
+        Material water = get_material(material::Water);
+        Material water78 = get_material(material::Water);
+        water78.I(78.0);
+        auto d0 = calculate_DataPoint(p, water, c);
+        auto d1 = calculate_DataPoint(p, water78, c);
+        CHECK(d1.range[400] != d0.range[400]);
+        CHECK(d1.range[400] == approx(d0.range[400]).R(3e-2));
+    }
     TEST_CASE("vector_inputs"){
         catima::Projectile p{12,6,6,1000};
         catima::Material water({
@@ -568,6 +838,39 @@ using namespace std;
       CHECK(res3[1] == approx(catima::dedx_from_range(p(energies[1]),graphite),0.1));
       CHECK(res3[2] == approx(catima::dedx_from_range(p(energies[2]),graphite),0.1));
     }
+    TEST_CASE("energy_in"){
+        catima::Projectile p{12,6,6,1000};
+        catima::Material graphite;
+        graphite.add_element(12,6,1);
+        graphite.density(2.0);
+        graphite.thickness(0.5);
+
+        for(double e:{60.0, 100.0, 500.0, 1000.0, 5000.0}){
+            double eout = catima::energy_out(p(e),graphite);
+            double ein = catima::energy_in(p(eout),graphite);
+            CHECK(ein == approx(e).R(1e-4));
+        }
+
+        graphite.thickness(10);
+        double eout = catima::energy_out(p(1000),graphite);
+        CHECK(catima::energy_in(p(eout),graphite) == approx(1000).R(1e-4));
+        // stopped particle, energy needed to stop exactly at the end
+        double emin = catima::energy_in(p(0.0),graphite);
+        CHECK(catima::range(p(emin),graphite) == approx(10,0.001));
+
+        std::vector<double> energies{500,1000,2000};
+        auto eout_v = catima::energy_out(p,energies,graphite);
+        auto ein_v = catima::energy_in(p,eout_v,graphite);
+        CHECK(ein_v.size()==energies.size());
+        for(std::size_t i=0;i<energies.size();i++){
+            CHECK(ein_v[i] == approx(energies[i]).R(1e-4));
+        }
+
+        graphite.thickness(0.0);
+        CHECK(catima::energy_in(p(100),graphite) == 100.0);
+        graphite.thickness(1e9);
+        CHECK(catima::energy_in(p(100),graphite) == -1.0);
+    }
     TEST_CASE("constants"){
         using namespace catima;
         CHECK(0.1*hbar*c_light/atomic_mass_unit == approx(0.21183,0.0001));
@@ -0,0 +1,92 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_SUPER_FAST_ASSERTS
+#include "doctest.h"
+#include <math.h>
+#include "testutils.h"
+#include "catima/catima.h"
+#include "catima/gwm_integrators.h"
+#include "catima/nucdata.h"
+#include "catima/material_database.h"
+using namespace std;
+
+    TEST_CASE("forward and reverse integration"){
+      catima::Projectile p(12,6);
+      catima::Material graphite = catima::get_material(6);
+      catima::IntegrationSettings s;
+      for(double th:{0.0005, 0.5, 20.0}){
+          graphite.thickness(th);
+          for(double T:{100.0, 1000.0}){
+              if(catima::range(p(T),graphite)<=th)continue;
+              auto r = catima::integrate_energyloss(p(T), graphite, s);
+              CHECK(!r.stopped);
+              CHECK(r.converged);
+              CHECK(r.T == approx(catima::energy_out(p(T),graphite)).R(1e-5));
+              CHECK(r.Eloss == approx((T-r.T)*p.A).R(1e-12));
+
+              auto rr = catima::reverse_integrate_energyloss(p(r.T), graphite, s);
+              CHECK(rr.T == approx(T).R(1e-6));
+
+              s.use_spline = true;
+              auto rs = catima::integrate_energyloss(p(T), graphite, s);
+              CHECK(rs.T == approx(r.T).R(1e-5));
+              s.use_spline = false;
+          }
+      }
+      // much less evaluations than thickness steps
+      graphite.thickness(20.0);
+      auto r = catima::integrate_energyloss(p(1000), graphite, s);
+      CHECK(r.nevals < 100);
+    }
+
+    TEST_CASE("stopping"){
+      catima::Projectile p(12,6);
+      catima::Material graphite = catima::get_material(6);
+      graphite.thickness(5.0);
+      catima::IntegrationSettings s;
+      auto r = catima::integrate_energyloss(p(100), graphite, s);
+      CHECK(r.stopped);
+      CHECK(r.T == 0.0);
+      CHECK(r.Eloss == approx(100*12, 1e-9));
+      s.use_spline = true;
+      r = catima::integrate_energyloss(p(100), graphite, s);
+      CHECK(r.stopped);
+      CHECK(r.Eloss == approx(100*12, 1e-9));
+    }
+
+    TEST_CASE("old interface"){
+      catima::Projectile p1(catima::element_atomic_weight(1), 1.0, 0, 3.0);
+      catima::Material mat1(catima::get_material(6));
+      mat1.density(2.23).thickness(500.0*1e-6);
+      double eloss = catima::integrate_energyloss(p1, mat1);
+      CHECK(p1.T < 3.0);
+      CHECK(eloss == approx((3.0-p1.T)*p1.A).R(1e-12));
+      double eloss2 = catima::reverse_integrate_energyloss(p1, mat1);
+      CHECK(p1.T == approx(3.0).R(1e-6));
+      CHECK(eloss2 == approx(eloss).R(1e-5));
+    }
+
+    TEST_CASE("batch integration"){
+      catima::Projectile p(4,2);
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness(1.0);
+      std::vector<double> energies{20, 50, 100, 200, 500};
+      catima::ThreadPool pool(3);
+      for(bool spline:{false, true}){
+          catima::IntegrationSettings s;
+          s.use_spline = spline;
+          auto res = catima::integrate_energyloss(p, energies, water, s, catima::default_config, pool);
+          CHECK(res.size() == energies.size());
+          std::vector<double> eout;
+          for(std::size_t i=0;i<energies.size();i++){
+              auto r = catima::integrate_energyloss(p(energies[i]), water, s);
+              CHECK(res[i].T == r.T);
+              CHECK(res[i].stopped == r.stopped);
+              eout.push_back(r.T);
+          }
+          auto rev = catima::reverse_integrate_energyloss(p, eout, water, s, catima::default_config, pool);
+          for(std::size_t i=0;i<energies.size();i++){
+              if(res[i].stopped)continue;
+              CHECK(rev[i].T == approx(energies[i]).R(1e-5));
+          }
+      }
+    }
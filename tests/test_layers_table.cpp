@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_SUPER_FAST_ASSERTS
+#include "doctest.h"
+#include <math.h>
+#include "testutils.h"
+#include "catima/catima.h"
+#include "catima/layers_table.h"
+#include "catima/material_database.h"
+using namespace std;
+
+    TEST_CASE("layers table"){
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness_cm(1.0);
+      catima::Material graphite = catima::get_material(6);
+      graphite.thickness(0.5);
+      catima::Material al = catima::get_material(13);
+      al.thickness(0.2);
+      catima::Layers layers;
+      layers.add(water);
+      layers.add(graphite);
+      layers.add(al);
+      layers.add(water);
+
+      catima::Phasespace ps{0.1, 0.002, 0.0001};
+      for(auto p: {catima::Projectile(12,6), catima::Projectile(238,92), catima::Projectile(1,1)}){
+          catima::LayersTable table(p, layers);
+          CHECK(table.threshold()>0.0);
+          CHECK(table.get_min()>table.threshold());
+          CHECK(catima::calculate(p(table.threshold()*0.999), layers).total_result.Eout == 0.0);
+          CHECK(catima::calculate(p(table.threshold()*1.001), layers).total_result.Eout > 0.0);
+
+          for(double T = table.get_min(); T<table.get_max(); T*=1.13){
+              auto r = catima::calculate(p(T), ps, layers).total_result;
+              auto t = table(T, ps);
+              CHECK(t.Ein == r.Ein);
+              CHECK(t.Eout == approx(r.Eout).R(1e-4));
+              CHECK(t.sigma_E == approx(r.sigma_E).R(1e-4));
+              CHECK(t.sigma_a == approx(r.sigma_a).R(1e-4));
+              CHECK(t.sigma_x == approx(r.sigma_x).R(1e-4));
+              CHECK(t.cov == approx(r.cov).R(1e-4));
+              CHECK(t.tof == approx(r.tof).R(1e-4));
+              #ifdef REACTIONS
+              if(r.sp<0)CHECK(t.sp == r.sp);
+              else CHECK(t.sp == approx(r.sp).R(1e-4));
+              #endif
+          }
+
+          // outside of the table full calculation is used
+          double T = table.threshold()*1.0001;
+          auto r = catima::calculate(p(T), ps, layers).total_result;
+          CHECK(table(T, ps).Eout == r.Eout);
+          CHECK(table(T, ps).sigma_x == r.sigma_x);
+          CHECK(table(0.5*table.threshold()).Eout == 0.0);
+      }
+    }
+
+    TEST_CASE("layers table movable"){
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness_cm(2.0);
+      catima::Layers layers;
+      layers.add(water);
+      catima::Projectile p(12,6);
+      std::vector<catima::LayersTable> tables;
+      tables.emplace_back(p, layers);
+      tables.emplace_back(catima::Projectile(4,2), layers);
+      auto r = catima::calculate(p(500), layers).total_result;
+      CHECK(tables[0](500).Eout == approx(r.Eout).R(1e-4));
+      CHECK(tables[0].get_projectile().A == 12);
+
+      catima::Layers thick;
+      water.thickness(1000);
+      thick.add(water);
+      catima::LayersTable stopped(p, thick, catima::default_config, 100);
+      CHECK(stopped.get_min() == 0.0);
+      CHECK(stopped(50).Eout == 0.0);
+    }
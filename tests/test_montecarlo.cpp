@@ -0,0 +1,119 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_SUPER_FAST_ASSERTS
+#include "doctest.h"
+#include <math.h>
+#include "testutils.h"
+#include "catima/catima.h"
+#include "catima/montecarlo.h"
+#include "catima/material_database.h"
+using namespace std;
+
+    TEST_CASE("random stream"){
+      catima::RandomStream r1(1234, 5);
+      catima::RandomStream r2(1234, 5);
+      catima::RandomStream r3(1234, 6);
+      double sum=0, sum2=0;
+      const int n = 200000;
+      for(int i=0;i<n;i++){
+          double a = r1.normal();
+          CHECK(a == r2.normal());
+          sum += a;
+          sum2 += a*a;
+      }
+      CHECK(r1.uniform() != r3.uniform());
+      CHECK(sum/n == approx(0.0, 0.01));
+      CHECK(sum2/n == approx(1.0, 0.01));
+
+      double umin = 1, umax = 0;
+      for(int i=0;i<n;i++){
+          double u = r3.uniform();
+          umin = std::min(u, umin);
+          umax = std::max(u, umax);
+      }
+      CHECK(umin > 0.0);
+      CHECK(umax < 1.0);
+    }
+
+    TEST_CASE("transport"){
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness_cm(1.0);
+      catima::Material graphite = catima::get_material(6);
+      graphite.thickness(0.5);
+      catima::Layers layers;
+      layers.add(water);
+      layers.add(graphite);
+      catima::Projectile p(12,6);
+
+      catima::Beam beam;
+      beam.T = 500;
+      beam.x = {0.1, 0.002, 0.0};
+      beam.y = {0.1, 0.002, 0.0};
+
+      catima::MonteCarloTransport mc(p, layers);
+      const std::size_t n = 100000;
+      auto particles = catima::generate_particles(beam, n, 42);
+      CHECK(particles.size() == n);
+      CHECK(particles.count_alive() == n);
+      mc.transport(particles, 42);
+
+      auto r = catima::calculate(p(500), catima::Phasespace{0.1, 0.002, 0.0}, layers).total_result;
+      double mean=0, mean2=0, x2=0, a2=0;
+      std::size_t nalive = particles.count_alive();
+      for(std::size_t i=0;i<n;i++){
+          if(!particles.alive[i])continue;
+          mean += particles.T[i];
+          mean2 += particles.T[i]*particles.T[i];
+          x2 += particles.x[i]*particles.x[i];
+          a2 += particles.ax[i]*particles.ax[i];
+      }
+      mean /= nalive;
+      double sigma = sqrt(mean2/nalive - mean*mean);
+      CHECK(mean == approx(r.Eout).R(1e-4));
+      CHECK(sigma == approx(r.sigma_E).R(0.02));
+      CHECK(sqrt(x2/nalive) == approx(r.sigma_x).R(0.02));
+      CHECK(sqrt(a2/nalive) == approx(r.sigma_a).R(0.02));
+      #ifdef REACTIONS
+      CHECK((double)nalive/n == approx(r.sp, 0.005));
+      #endif
+
+      // reproducible and independent of threads
+      catima::ThreadPool pool(4);
+      auto particles2 = catima::generate_particles(beam, n, 42, 0, pool);
+      mc.transport(particles2, 42, 0, pool);
+      CHECK(particles2.T == particles.T);
+      CHECK(particles2.x == particles.x);
+      CHECK(particles2.ay == particles.ay);
+      CHECK(particles2.alive == particles.alive);
+
+      // different seed
+      auto particles3 = catima::generate_particles(beam, n, 43);
+      mc.transport(particles3, 43);
+      CHECK(particles3.T != particles.T);
+
+      // histogram gives the same particles
+      auto h = mc.histogram(beam, n, 42, catima::mc_variable::T, 100, mean-5*sigma, mean+5*sigma);
+      CHECK(h.integral() + h.underflow + h.overflow == nalive);
+      catima::Histogram h2(100, mean-5*sigma, mean+5*sigma);
+      for(std::size_t i=0;i<n;i++){
+          if(particles.alive[i])h2.fill(particles.T[i]);
+      }
+      CHECK(h.counts == h2.counts);
+      auto h3 = mc.histogram(beam, n, 42, catima::mc_variable::T, 100, mean-5*sigma, mean+5*sigma, pool);
+      CHECK(h3.counts == h.counts);
+    }
+
+    TEST_CASE("transport stopping"){
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness_cm(10.0);
+      catima::Layers layers;
+      layers.add(water);
+      catima::Projectile p(1,1);
+      catima::MonteCarloTransport mc(p, layers);
+      mc.set_reactions(false);
+      catima::Beam beam;
+      beam.T = 5;
+      auto particles = catima::generate_particles(beam, 1000, 1);
+      mc.transport(particles, 1);
+      CHECK(particles.count_alive() == 0);
+      CHECK(particles.T[0] == 0.0);
+    }
@@ -0,0 +1,130 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_SUPER_FAST_ASSERTS
+#include "doctest.h"
+#include <math.h>
+#include "testutils.h"
+#include "catima/catima.h"
+#include "catima/phasespace.h"
+#include "catima/material_database.h"
+using namespace std;
+using namespace catima::ps_index;
+
+    TEST_CASE("matrix"){
+      catima::SigmaMatrix4 s;
+      for(int i=0;i<4;i++)
+          for(int j=0;j<4;j++)s(i,j) = i*4+j;
+      auto id = catima::SigmaMatrix4::identity();
+      CHECK(s*id == s);
+      CHECK(id*s == s);
+      CHECK(s.transpose()(1,2) == s(2,1));
+      CHECK(s.block<2>()(1,1) == s(1,1));
+      CHECK((s+s)(3,2) == 2*s(3,2));
+
+      catima::Phasespace ps{0.1, 0.002, 1e-5};
+      auto sigma = catima::sigma_matrix(ps, {0.2, 0.003, 0.0});
+      auto psx = catima::to_phasespace(sigma);
+      auto psy = catima::to_phasespace(sigma, 1);
+      CHECK(psx.sigma_x == approx(0.1).R(1e-12));
+      CHECK(psx.cov_x == 1e-5);
+      CHECK(psy.sigma_a == approx(0.003).R(1e-12));
+    }
+
+    TEST_CASE("transport compared to calculate"){
+      catima::Projectile p(12,6);
+      catima::Layers layers;
+      catima::Material graphite = catima::get_material(6);
+      graphite.thickness(0.5);
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness(1.0);
+      layers.add(graphite);
+      layers.add(water);
+      layers.add(graphite);
+
+      catima::Phasespace ps{0.1, 0.002, 1e-5};
+      for(double T:{200.0, 500.0, 1000.0}){
+          auto res = catima::calculate(p(T), ps, layers);
+          auto map = catima::transport_map(p(T), layers);
+          CHECK(map.Ein == T);
+          CHECK(map.Eout == approx(res.total_result.Eout).R(1e-9));
+          CHECK(!map.stopped);
+
+          auto s2 = catima::transport(p(T), catima::sigma_matrix(ps), layers);
+          auto out = catima::to_phasespace(s2);
+          CHECK(out.sigma_x == approx(res.total_result.sigma_x).R(1e-9));
+          CHECK(out.sigma_a == approx(res.total_result.sigma_a).R(1e-9));
+          CHECK(out.cov_x == approx(res.total_result.cov).R(1e-9));
+
+          // y plane is independent and identical for symmetric beam
+          auto s4 = catima::transport(p(T), catima::sigma_matrix(ps, ps), layers);
+          CHECK(s4(x,y) == 0.0);
+          CHECK(s4(y,y) == approx(s2(x,x)).R(1e-12));
+          CHECK(s4(b,b) == approx(s2(a,a)).R(1e-12));
+
+          // energy spread from straggling only
+          catima::SigmaMatrix6 s6;
+          auto o6 = map(s6);
+          double sE = res.total_result.sigma_E/res.total_result.Eout;
+          CHECK(std::sqrt(o6(d,d)) == approx(sE).R(0.05));
+          CHECK(o6.block<4>()(x,x) == approx(map.reduce<4>()(s6.block<4>())(x,x)).R(1e-12));
+      }
+    }
+
+    TEST_CASE("dispersion"){
+      catima::Projectile p(12,6);
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness(5.0);
+      for(double T:{200.0, 500.0}){
+          auto map = catima::transport_map(p(T), water);
+          auto w = catima::w_magnification(p, T, water);
+          CHECK(map.R(d,d) == approx(w.first).R(1e-3));
+          CHECK(map.R(t,d) < 0.0); // faster particles arrive earlier
+      }
+
+      // composition of maps equals map of the layers
+      catima::Layers layers;
+      water.thickness(5.0);
+      layers.add(water);
+      layers.add(water);
+      auto m1 = catima::transport_map(p(500), water);
+      auto m2 = catima::transport_map(p(m1.Eout), water);
+      auto m12 = m1.then(m2);
+      auto ml = catima::transport_map(p(500), layers);
+      CHECK(ml.Eout == approx(m12.Eout).R(1e-12));
+      for(int i=0;i<6;i++)
+          for(int j=0;j<6;j++){
+              CHECK(ml.R(i,j) == approx(m12.R(i,j)).epsilon(1e-12));
+              CHECK(ml.Q(i,j) == approx(m12.Q(i,j)).epsilon(1e-12));
+          }
+
+      // stopped beam
+      water.thickness(100.0);
+      auto ms = catima::transport_map(p(100), water);
+      CHECK(ms.stopped);
+      CHECK(ms.Eout < catima::Ezero);
+    }
+
+    TEST_CASE("batch transport"){
+      catima::Projectile p(1,1);
+      catima::Layers layers;
+      catima::Material water = catima::get_material(catima::material::Water);
+      water.thickness(2.0);
+      layers.add(water);
+      layers.add(water);
+      std::vector<double> energies{50, 100, 200, 500, 1000};
+      std::vector<catima::SigmaMatrix4> sigmas;
+      for(std::size_t i=0;i<energies.size();i++){
+          sigmas.push_back(catima::sigma_matrix({0.1*(i+1), 0.001, 0.0}, {0.2, 0.002, 0.0}));
+      }
+      catima::ThreadPool pool(4);
+      auto res = catima::transport(p, energies, sigmas, layers, catima::default_config, pool);
+      CHECK(res.size() == energies.size());
+      for(std::size_t i=0;i<energies.size();i++){
+          CHECK(res[i] == catima::transport(p(energies[i]), sigmas[i], layers));
+      }
+
+      auto map = catima::transport_map(p(200), layers);
+      auto res2 = catima::transport(map.reduce<4>(), sigmas, pool);
+      for(std::size_t i=0;i<sigmas.size();i++){
+          CHECK(res2[i] == map.reduce<4>()(sigmas[i]));
+      }
+    }
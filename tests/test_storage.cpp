@@ -5,6 +5,14 @@
 #include "testutils.h"
 #include "catima/catima.h"   
 #include "catima/storage.h"   
+#include "catima/table_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
 using namespace std;
 using catima::LN10;
 
@@ -156,3 +164,127 @@ using catima::LN10;
           
       }
     }
+
+#ifndef GSL_INTERPOLATION
+    TEST_CASE("spline coefficients"){
+      catima::Projectile p{12,6};
+      catima::Material water = catima::get_material(catima::material::Water);
+      auto dp = catima::_shared_storage.Get(p, water);
+      catima::spline_type spline = catima::get_range_spline(*dp);
+      const auto &ss = spline.coefficients();
+      CHECK(ss.m_y == dp->range.data());
+      for(int i : {10, 200, 401, catima::max_datapoints-2}){
+          double x0 = catima::energy_table[i];
+          double h = 0.3*(catima::energy_table[i+1] - x0);
+          double y = ((ss.m_a[i]*h + ss.m_b[i])*h + ss.m_c[i])*h + ss.m_y[i];
+          CHECK(y == approx(spline(x0+h)).R(1e-12));
+      }
+    }
+#endif
+
+    TEST_CASE("table file"){
+      catima::Projectile p1{12,6};
+      catima::Projectile p2{4,2,1};
+      catima::Material water = catima::get_material(catima::material::Water);
+      catima::Material graphite = catima::get_material(6);
+      graphite.I(80.0);
+      catima::Config c2;
+      c2.z_effective = catima::z_eff_type::winger;
+      std::vector<std::shared_ptr<const catima::DataPoint>> data{
+          catima::_shared_storage.Get(p1, water),
+          catima::_shared_storage.Get(p2, graphite, c2)};
+      const char *fname = "test_table_file.bin";
+      REQUIRE(catima::save_tables(fname, data));
+
+      std::vector<std::shared_ptr<const catima::DataPoint>> loaded;
+      REQUIRE(catima::load_tables(fname, loaded));
+      REQUIRE(loaded.size()==data.size());
+      for(std::size_t k=0;k<data.size();k++){
+          CHECK(*loaded[k] == *data[k]);
+          CHECK(loaded[k]->range == data[k]->range);
+          CHECK(loaded[k]->range_straggling == data[k]->range_straggling);
+          CHECK(loaded[k]->angular_variance == data[k]->angular_variance);
+          auto a = catima::calculate(*loaded[k], 321.0, data[k]->m);
+          auto b = catima::calculate(*data[k], 321.0, data[k]->m);
+          CHECK(a.Eout == b.Eout);
+          CHECK(a.sigma_a == b.sigma_a);
+          CHECK(a.range == b.range);
+      }
+
+      catima::SharedData storage;
+      REQUIRE(catima::load_tables(fname, storage));
+      CHECK(storage.GetN()==2);
+      CHECK(storage.Get(p2, graphite, c2)->range == data[1]->range);
+      CHECK(storage.GetN()==2);
+
+      // different energy grid is rejected
+      {
+          std::fstream f(fname, std::ios::in|std::ios::out|std::ios::binary);
+          f.seekp(sizeof(catima::TableFileHeader)+8*10);
+          double e = 1.0;
+          f.write(reinterpret_cast<const char*>(&e), sizeof(e));
+      }
+      std::vector<std::shared_ptr<const catima::DataPoint>> rejected;
+      CHECK_FALSE(catima::load_tables(fname, rejected));
+      CHECK(rejected.empty());
+      CHECK_FALSE(catima::load_tables("nonexistent_table_file.bin", rejected));
+
+      // truncated and corrupted files are rejected
+      REQUIRE(catima::save_tables(fname, data));
+      std::string content;
+      {
+          std::ifstream f(fname, std::ios::binary);
+          content.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+      }
+      // file is little-endian on every host
+      {
+          const std::size_t pos = offsetof(catima::TableFileHeader, byte_order);
+          CHECK(content.substr(pos, 4) == std::string("\x04\x03\x02\x01", 4));
+          std::uint64_t bits = 0;
+          for(int i=7;i>=0;i--)bits = (bits<<8) | static_cast<unsigned char>(content[sizeof(catima::TableFileHeader)+i]);
+          double e0;
+          std::memcpy(&e0, &bits, sizeof(e0));
+          CHECK(e0 == catima::energy_table[0]);
+      }
+      auto write_file = [&](const std::string &c){
+          std::ofstream f(fname, std::ios::binary|std::ios::trunc);
+          f.write(c.data(), c.size());
+      };
+      auto set_header_count = [&](std::uint64_t catima::TableFileHeader::*field, std::uint64_t v){
+          std::string c = content;
+          catima::TableFileHeader h;
+          std::memcpy(&h, c.data(), sizeof(h));
+          h.*field = v;
+          std::memcpy(&c[0], &h, sizeof(h));
+          return c;
+      };
+      for(std::size_t size:{std::size_t(0), std::size_t(4), sizeof(catima::TableFileHeader), content.size()/2, content.size()-1}){
+          write_file(content.substr(0, size));
+          CHECK_FALSE(catima::load_tables(fname, rejected));
+      }
+      write_file(content+"x");
+      CHECK_FALSE(catima::load_tables(fname, rejected));
+      write_file(set_header_count(&catima::TableFileHeader::ndata, std::uint64_t(1)<<61));
+      CHECK_FALSE(catima::load_tables(fname, rejected));
+      write_file(set_header_count(&catima::TableFileHeader::ndata, ~std::uint64_t(0)));
+      CHECK_FALSE(catima::load_tables(fname, rejected));
+      write_file(set_header_count(&catima::TableFileHeader::nelements, std::uint64_t(1)<<62));
+      CHECK_FALSE(catima::load_tables(fname, rejected));
+      write_file(set_header_count(&catima::TableFileHeader::ndata, 3));
+      CHECK_FALSE(catima::load_tables(fname, rejected));
+      {
+          // element range of the first record points outside of the elements array
+          std::string c = content;
+          catima::TableFileRecord r;
+          const std::size_t pos = sizeof(catima::TableFileHeader)+8*catima::max_datapoints;
+          std::memcpy(&r, &c[pos], sizeof(r));
+          r.first_element = ~std::uint64_t(0);
+          std::memcpy(&c[pos], &r, sizeof(r));
+          write_file(c);
+          CHECK_FALSE(catima::load_tables(fname, rejected));
+      }
+      CHECK(rejected.empty());
+      write_file(content);
+      CHECK(catima::load_tables(fname, rejected));
+      std::remove(fname);
+    }
@@ -75,6 +75,76 @@ using namespace std;
         CHECK(m.get_element(1).Z == 8);
         CHECK(m.density() == 1.0);
     }
+    TEST_CASE("interned materials"){
+        const catima::Material &w = catima::interned_material(catima::material::Water);
+        CHECK(&w == &catima::interned_material(206));
+        CHECK(w == catima::Material({{0,1,2},{0,8,1}},1));
+        CHECK(w.fingerprint() == catima::get_material(catima::material::Water).fingerprint());
+        CHECK(catima::interned_material(6) == catima::get_material(6));
+        CHECK(catima::interned_material(0).ncomponents() == 0);
+        CHECK(catima::interned_material(10000).ncomponents() == 0);
+
+        CHECK(catima::material_id("Water") == 206);
+        CHECK(catima::material_id("Nylon") == static_cast<int>(catima::material::Nylon));
+        CHECK(catima::material_id("Waterx") == 0);
+        CHECK(catima::material_id("") == 0);
+        CHECK(std::string(catima::material_name(catima::material::Air)) == "Air");
+        for(int id=201;id<=347;id++){
+            auto m = static_cast<catima::material>(id);
+            const catima::MaterialRecord *r = catima::material_record(m);
+            REQUIRE(r != nullptr);
+            CHECK(catima::material_id(r->name) == id);
+            CHECK(catima::interned_material(id).ncomponents() == static_cast<int>(r->n));
+            CHECK(catima::get_compound(m) == catima::interned_material(id));
+        }
+        CHECK(catima::material_record(static_cast<catima::material>(348)) == nullptr);
+
+        catima::Material a({{0,1,2},{0,8,1}},1);
+        catima::Material b({{0,1,2},{0,8,1}},2);
+        CHECK(a.fingerprint() == b.fingerprint());
+        a.I(78);
+        CHECK(a.fingerprint() != b.fingerprint());
+        CHECK_FALSE(a == b);
+        b.I(78);
+        CHECK(a.fingerprint() == b.fingerprint());
+        b.add_element(0,6,1);
+        CHECK(a.fingerprint() != b.fingerprint());
+    }
+    TEST_CASE("Material element storage"){
+        catima::Material small = catima::get_material(catima::material::Water);
+        catima::Material m1 = small;
+        CHECK(m1 == small);
+        CHECK(m1.ncomponents() == 2);
+
+        catima::Material big;
+        for(int z=1;z<=12;z++){
+            big.add_element(0,z,1);
+        }
+        CHECK(big.ncomponents() == 12);
+        catima::Material big2 = big;
+        CHECK(big2 == big);
+        for(int i=0;i<12;i++){
+            CHECK(big2.get_element(i).Z == i+1);
+        }
+        catima::Material moved = std::move(big2);
+        CHECK(moved == big);
+        m1 = big;
+        CHECK(m1 == big);
+        m1 = small;
+        CHECK(m1 == small);
+        CHECK(m1.ncomponents() == 2);
+
+        catima::small_vector<catima::Target, 2> v;
+        CHECK(v.is_inline());
+        v.push_back({1,1,1});
+        v.push_back({4,2,1});
+        CHECK(v.is_inline());
+        v.push_back({12,6,1});
+        CHECK_FALSE(v.is_inline());
+        CHECK(v.size() == 3);
+        CHECK(v[2].Z == 6);
+        CHECK(v[0].Z == 1);
+    }
     TEST_CASE("Layers"){
         catima::Material water2;
         water2.add_element(1,1,2);